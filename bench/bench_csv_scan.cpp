@@ -0,0 +1,125 @@
+// Microbenchmark for the csv structural indexer (src/csv_index.h).
+// Compares the per-character quote/comma loop against the vectorized scanner backends.
+// usage: ./bench_csv_scan [papers_with_labels.csv ...]
+
+#include "../src/csv_index.h"
+#include "../src/mapped_file.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// number of times each scan is repeated (best time is reported)
+constexpr int NUM_RUNS {5};
+
+// synthetic rows shaped like papers_with_labels.csv (quoted titles & labels with commas)
+std::string generateSynthetic(const std::size_t numRows)
+{
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<double> pos{-50.0, 50.0};
+    std::string data {"title,included,x2,y2,x3,y3,z3,c2_2d,c2_3d,c3_2d,c3_3d,c4_2d,c4_3d,c5_2d,c5_3d,c6_2d,c6_3d,"
+                      "l2_2d,l3_2d,l4_2d,l5_2d,l6_2d,l2_3d,l3_3d,l4_3d,l5_3d,l6_3d\n"};
+    for (std::size_t r{0}; r < numRows; ++r)
+    {
+        data += "\"A study of things, stuff and \"\"other\"\" matters no. " + std::to_string(r) + "\",";
+        data += (rng() % 10 == 0) ? "1" : "0";
+        for (int i{0}; i < 5; ++i)
+        {
+            data += ',' + std::to_string(pos(rng));
+        }
+        for (int k{2}; k <= 6; ++k)
+        {
+            data += ',' + std::to_string(rng() % (1u << k)) + ',' + std::to_string(rng() % (1u << k));
+        }
+        for (int l{0}; l < 10; ++l)
+        {
+            data += ",\"Label " + std::to_string(rng() % 64) + ", machine learning\"";
+        }
+        data += '\n';
+    }
+    return data;
+}
+
+// the per-character loop PaperLoader used before the scanner, returns number of fields
+std::size_t scanLoop(const std::string_view data)
+{
+    std::size_t numFields{0};
+    bool quote{false};
+    for (const char c : data)
+    {
+        if (c == '"') {
+            quote = !quote;
+        } else if (!quote && (c == ',' || c == '\n'))
+        {
+            ++numFields;
+        }
+    }
+    return numFields;
+}
+
+std::size_t scanIndexed(const std::string_view data, const CsvIndex::Backend backend)
+{
+    std::size_t numFields{0};
+    CsvIndex::Scanner scanner{data.data(), data.data() + data.size(), backend};
+    std::vector<const char*> structurals;
+    structurals.reserve(CsvIndex::WINDOW_SIZE / 8);
+    while (scanner.next(structurals))
+    {
+        numFields += structurals.size();
+    }
+    return numFields;
+}
+
+template <typename F>
+void run(const std::string& name, const std::string_view data, F&& scan)
+{
+    double best {1e30};
+    std::size_t numFields{0};
+    for (int i{0}; i < NUM_RUNS; ++i)
+    {
+        const auto start {std::chrono::steady_clock::now()};
+        numFields = scan(data);
+        const std::chrono::duration<double> time {std::chrono::steady_clock::now() - start};
+        best = std::min(best, time.count());
+    }
+    std::cout << "\t" << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << static_cast<double>(data.size()) / best / 1e6 << " MB/s  (" << numFields << " fields)\n";
+}
+
+void benchmark(const std::string& name, const std::string_view data)
+{
+    std::cout << name << " (" << data.size() / 1000000 << " MB):\n";
+    run("loop", data, scanLoop);
+    run("scalar", data, [](const std::string_view d) { return scanIndexed(d, CsvIndex::Backend::SCALAR); });
+    const CsvIndex::Backend best {CsvIndex::detectBackend()};
+    if (best != CsvIndex::Backend::SCALAR)
+    {
+        run("sse2", data, [](const std::string_view d) { return scanIndexed(d, CsvIndex::Backend::SSE2); });
+    }
+    if (best == CsvIndex::Backend::AVX2)
+    {
+        run("avx2", data, [](const std::string_view d) { return scanIndexed(d, CsvIndex::Backend::AVX2); });
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    std::cout << "Detected backend: " << CsvIndex::getBackendName(CsvIndex::detectBackend()) << '\n';
+    benchmark("synthetic", generateSynthetic(200000));
+    for (int i{1}; i < argc; ++i)
+    {
+        const MappedFile file{argv[i]};
+        if (!file.isOpen())
+        {
+            std::cerr << "Error: Failed to read file from path: `" << argv[i] << "`" << std::endl;
+            continue;
+        }
+        benchmark(argv[i], file.view());
+    }
+    return 0;
+}
@@ -0,0 +1,336 @@
+// Ingest benchmark for PaperLoader on synthetic papers_with_labels.csv files of increasing size.
+// Files are generated deterministically (same bytes on every run & platform) and reused if they already exist.
+// Results are printed to stdout as JSON, progress goes to stderr.
+// usage: ./bench_ingest [--dir path] [rows ...]   (default: 150000 1000000 10000000 rows in the temp directory)
+
+#include "../src/paper_cache.h"
+#include "../src/paper_loader.h"
+#include "../src/thread_pool.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+constexpr float SCALE {5.0f};
+constexpr std::size_t DEFAULT_ROWS[] {150000, 1000000, 10000000};
+
+// ---- synthetic corpus ---- //
+
+// splitmix64, std distributions aren't guaranteed to give the same numbers on every standard library
+class Random
+{
+public:
+    explicit Random(const std::uint64_t seed) : m_state{seed} {}
+
+    std::uint64_t next()
+    {
+        std::uint64_t z {m_state += 0x9E3779B97F4A7C15ull};
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // uniform in [0, n)
+    std::uint32_t below(const std::uint32_t n) {return static_cast<std::uint32_t>((next() >> 32) * n >> 32);}
+    // uniform in [-1, 1)
+    double signedUnit() {return static_cast<double>(next() >> 11) * 0x1.0p-52 - 1.0;}
+
+private:
+    std::uint64_t m_state;
+};
+
+// title words, some with commas, quotes & multi-byte utf-8 (written as escapes so the source encoding doesn't matter)
+constexpr std::string_view WORDS[] {
+    "learning", "graph", "neural", "networks", "deep", "analysis", "of", "the", "for", "a", "model", "systems",
+    "na\xC3\xAFve", "Schr\xC3\xB6" "dinger", "caf\xC3\xA9", "\xE2\x80\x93", "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E", "\xCE\xB1-\xCE\xB2",
+    "efficient,", "robust,", "\"fast\"", "survey:", "3D", "visualization", "clustering", "\xF0\x9F\x93\x88"};
+constexpr std::string_view TOPICS[] {
+    "Machine learning", "Computer vision", "Natural language", "Graph theory", "Data visualization", "Optimization",
+    "Signal processing", "Robotics"};
+
+// writes a csv field, quoted (with doubled quotes) if it contains a comma, quote or newline
+void writeField(std::string& out, const std::string_view field)
+{
+    if (field.find_first_of(",\"\n") == std::string_view::npos)
+    {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (const char c : field)
+    {
+        if (c == '"')
+        {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+void writeNumber(std::string& out, const double value)
+{
+    char buffer[32];
+    const std::to_chars_result result {std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 6)};
+    out.append(buffer, result.ptr);
+}
+
+// cluster label for (depth, space, id), unique per cluster like the real labels
+std::string getLabel(const int depth, const int space, const std::uint32_t id)
+{
+    std::string label {TOPICS[(id + static_cast<std::uint32_t>(space) * 3) % std::size(TOPICS)]};
+    label += ", level " + std::to_string(depth) + (space == 0 ? " (2D) #" : " (3D) #") + std::to_string(id);
+    label += id % 4 == 0 ? " \xE2\x80\x93 \"core\"" : " \xC3\xBC" "ber";
+    return label;
+}
+
+// clusters are hierarchical (depth k has 2^k clusters, each splits into two at the next depth)
+// & papers are scattered around the centre of their depth 6 cluster
+bool generateCorpus(const std::string& filename, const std::size_t numRows)
+{
+    constexpr int NUM_LEAVES {1 << MAX_CLUSTER_DEPTH};
+    Random random{0x5EED};
+    double centres[2][NUM_LEAVES][3];
+    for (auto& space : centres)
+    {
+        for (auto& centre : space)
+        {
+            for (double& axis : centre)
+            {
+                axis = random.signedUnit() * 40.0;
+            }
+        }
+    }
+    std::vector<std::string> labels[2][NUM_CLUSTER_LEVELS];
+    for (int space{0}; space < 2; ++space)
+    {
+        for (int depth{MIN_CLUSTER_DEPTH}; depth <= MAX_CLUSTER_DEPTH; ++depth)
+        {
+            for (std::uint32_t id{0}; id < (1u << depth); ++id)
+            {
+                labels[space][depth - MIN_CLUSTER_DEPTH].push_back(getLabel(depth, space, id));
+            }
+        }
+    }
+
+    std::ofstream file {filename, std::ios::binary | std::ios::trunc};
+    if (!file)
+    {
+        return false;
+    }
+    std::string out {"title,included,x2,y2,x3,y3,z3,c2_2d,c2_3d,c3_2d,c3_3d,c4_2d,c4_3d,c5_2d,c5_3d,c6_2d,c6_3d,"
+                     "l2_2d,l3_2d,l4_2d,l5_2d,l6_2d,l2_3d,l3_3d,l4_3d,l5_3d,l6_3d\n"};
+    std::string title;
+    for (std::size_t row{0}; row < numRows; ++row)
+    {
+        title = "Paper " + std::to_string(row);
+        const std::uint32_t numWords {3 + random.below(10)};
+        for (std::uint32_t w{0}; w < numWords; ++w)
+        {
+            title += ' ';
+            title += WORDS[random.below(static_cast<std::uint32_t>(std::size(WORDS)))];
+        }
+        writeField(out, title);
+        // ~10% included, only in the first 70% of the file (like the real export)
+        out += random.below(10) == 0 && row * 10 < numRows * 7 ? ",1" : ",0";
+
+        const std::uint32_t leaves[2] {random.below(NUM_LEAVES), random.below(NUM_LEAVES)};
+        for (int axis{0}; axis < 2; ++axis)
+        {
+            out += ',';
+            writeNumber(out, centres[0][leaves[0]][axis] + random.signedUnit() * 6.0);
+        }
+        for (int axis{0}; axis < 3; ++axis)
+        {
+            out += ',';
+            writeNumber(out, centres[1][leaves[1]][axis] + random.signedUnit() * 6.0);
+        }
+        for (int depth{MIN_CLUSTER_DEPTH}; depth <= MAX_CLUSTER_DEPTH; ++depth)
+        {
+            for (const std::uint32_t leaf : leaves)
+            {
+                out += ',';
+                out += std::to_string(leaf >> (MAX_CLUSTER_DEPTH - depth));
+            }
+        }
+        for (int space{0}; space < 2; ++space)
+        {
+            for (int depth{MIN_CLUSTER_DEPTH}; depth <= MAX_CLUSTER_DEPTH; ++depth)
+            {
+                out += ',';
+                writeField(out, labels[space][depth - MIN_CLUSTER_DEPTH][leaves[space] >> (MAX_CLUSTER_DEPTH - depth)]);
+            }
+        }
+        out += '\n';
+
+        if (out.size() > (1 << 22))
+        {
+            file.write(out.data(), static_cast<std::streamsize>(out.size()));
+            out.clear();
+        }
+    }
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+// ---- measurements ---- //
+
+// resets the peak resident set size, so every size is measured on its own (linux only)
+void resetPeakMemory()
+{
+#ifdef __linux__
+    std::ofstream{"/proc/self/clear_refs"} << "5";
+#endif
+}
+
+// peak resident set size in bytes since the last reset, 0 if unknown
+std::size_t getPeakMemory()
+{
+#ifdef __linux__
+    std::ifstream status {"/proc/self/status"};
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.starts_with("VmHWM:"))
+        {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#else
+    return 0;
+#endif
+}
+
+double getSeconds(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct Result
+{
+    std::size_t rows{0};
+    std::size_t fileSize{0};
+    double firstPaper{0.0};
+    double load{0.0};
+    double clusters{0.0};
+    std::size_t peakMemory{0};
+    std::size_t tableMemory{0};
+};
+
+// time until the first batch is visible to the render loop (incl. the cache check), like the app does it
+double measureFirstPaper(const std::string& filename)
+{
+    std::filesystem::remove(PaperCache::getCachePath(filename));
+    PaperLoader loader{};
+    const auto start {std::chrono::steady_clock::now()};
+    loader.startStreaming(filename, SCALE);
+    while (loader.getNumPapers() == 0 && loader.isStreaming())
+    {
+        loader.pollBatches();
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+    }
+    // the loader cancels the rest of the stream when it goes out of scope (no cache is written)
+    return getSeconds(start);
+}
+
+Result measure(const std::string& filename, const std::size_t numRows)
+{
+    Result result{};
+    result.rows = numRows;
+    result.fileSize = static_cast<std::size_t>(std::filesystem::file_size(filename));
+    result.firstPaper = measureFirstPaper(filename);
+
+    resetPeakMemory();
+    PaperLoader loader{};
+    auto start {std::chrono::steady_clock::now()};
+    loader.loadFromFile(filename, SCALE);
+    result.load = getSeconds(start);
+    start = std::chrono::steady_clock::now();
+    loader.generateClusters();
+    result.clusters = getSeconds(start);
+    result.peakMemory = getPeakMemory();
+    result.tableMemory = loader.getPapers().getMemoryUsage();
+    if (loader.getNumPapers() != numRows)
+    {
+        std::cerr << "ERROR::BENCH_INGEST: loaded " << loader.getNumPapers() << " rows from `" << filename << "`, expected " << numRows << std::endl;
+    }
+    return result;
+}
+
+void printJson(const std::vector<Result>& results)
+{
+    std::cout << "{\n  \"benchmark\": \"ingest\",\n  \"threads\": " << ThreadPool::shared().size() << ",\n  \"results\": [";
+    for (std::size_t i{0}; i < results.size(); ++i)
+    {
+        const Result& r {results[i]};
+        std::cout << (i == 0 ? "\n" : ",\n") << "    {\"rows\": " << r.rows << ", \"file_bytes\": " << r.fileSize
+                  << ", \"load_s\": " << r.load << ", \"load_mb_per_s\": " << static_cast<double>(r.fileSize) / r.load / 1e6
+                  << ", \"load_rows_per_s\": " << static_cast<double>(r.rows) / r.load
+                  << ", \"clusters_s\": " << r.clusters << ", \"first_paper_s\": " << r.firstPaper
+                  << ", \"peak_rss_bytes\": " << r.peakMemory << ", \"table_bytes\": " << r.tableMemory << "}";
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+}
+
+int main(const int argc, char** argv)
+{
+    std::filesystem::path dir {std::filesystem::temp_directory_path()};
+    std::vector<std::size_t> sizes;
+    for (int i{1}; i < argc; ++i)
+    {
+        const std::string_view arg {argv[i]};
+        if (arg == "--dir" && i + 1 < argc)
+        {
+            dir = argv[++i];
+            continue;
+        }
+        std::size_t rows{0};
+        if (std::from_chars(arg.data(), arg.data() + arg.size(), rows).ec != std::errc{} || rows == 0)
+        {
+            std::cerr << "usage: " << argv[0] << " [--dir path] [rows ...]" << std::endl;
+            return 1;
+        }
+        sizes.push_back(rows);
+    }
+    if (sizes.empty())
+    {
+        sizes.assign(std::begin(DEFAULT_ROWS), std::end(DEFAULT_ROWS));
+    }
+
+    std::vector<Result> results;
+    std::streambuf* const out {std::cout.rdbuf()};
+    for (const std::size_t rows : sizes)
+    {
+        const std::string filename {(dir / ("bench_papers_" + std::to_string(rows) + ".csv")).string()};
+        if (!std::filesystem::exists(filename))
+        {
+            std::cerr << "Generating `" << filename << "`..." << std::endl;
+            if (!generateCorpus(filename, rows))
+            {
+                std::cerr << "Error: Failed to write file to path: `" << filename << "`" << std::endl;
+                return 1;
+            }
+        }
+        std::cerr << "Loading " << rows << " rows..." << std::endl;
+        // silence the loader's own output while timing
+        std::cout.rdbuf(nullptr);
+        results.push_back(measure(filename, rows));
+        std::cout.rdbuf(out);
+        std::cout.clear();
+    }
+    printJson(results);
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Benchmark for the parquet backend of PaperLoader, compared against the csv path on the same data.
+// (replaces the old parquet_reader.cpp experiment)
+// usage: ./bench_parquet_load data/papers_with_labels.csv data/papers_with_labels.parquet
+
+#include "../src/paper_loader.h"
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// number of times each load is repeated (best time is reported)
+constexpr int NUM_RUNS {5};
+constexpr float SCALE {5.0f};
+
+void run(const std::string& name, const std::string& filename, const std::function<void(PaperLoader&)>& load)
+{
+    std::error_code error;
+    const auto fileSize {std::filesystem::file_size(filename, error)};
+    if (error)
+    {
+        std::cerr << "Error: Failed to read file from path: `" << filename << "`" << std::endl;
+        return;
+    }
+
+    double best {1e30};
+    unsigned int numPapers{0};
+    std::streambuf* const out {std::cout.rdbuf()};
+    for (int i{0}; i < NUM_RUNS; ++i)
+    {
+        PaperLoader loader{};
+        // silence the loader's own output while timing
+        std::cout.rdbuf(nullptr);
+        const auto start {std::chrono::steady_clock::now()};
+        load(loader);
+        const std::chrono::duration<double> time {std::chrono::steady_clock::now() - start};
+        std::cout.rdbuf(out);
+        std::cout.clear();
+        best = std::min(best, time.count());
+        numPapers = loader.getNumPapers();
+    }
+    std::cout << "\t" << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << best * 1000.0 << " ms" << std::setw(10) << static_cast<double>(fileSize) / best / 1e6 << " MB/s"
+              << std::setw(12) << static_cast<double>(numPapers) / best / 1e6 << " M rows/s  (" << numPapers << " rows, "
+              << fileSize / 1000000 << " MB file)\n";
+}
+
+int main(const int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " <papers.csv> <papers.parquet>" << std::endl;
+        return 1;
+    }
+    const std::string csv {argv[1]};
+    const std::string parquet {argv[2]};
+    std::cout << "Loading papers (best of " << NUM_RUNS << "):\n";
+    run("csv", csv, [&csv](PaperLoader& loader) { loader.loadFromFile(csv, SCALE); });
+    run("parquet", parquet, [&parquet](PaperLoader& loader) { loader.loadFromParquet(parquet, SCALE); });
+    return 0;
+}
@@ -8,6 +8,8 @@
 // cluster and paper management
 #include "src/paper_loader.h" // loading papers & clusters
 #include "src/clusters.h" // rendering clusters
+#include "src/paper_octree.h" // culling papers
+#include "src/paper_picker.h" // hovering & selecting papers
 // small struct for bar charts
 #include "src/bar_chart.h"
 
@@ -17,19 +19,37 @@
 #include <iomanip>
 #include <algorithm>
 #include <cstdlib>
+#include <future>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <cstddef>
 
 // constants
 constexpr unsigned int FONT_SIZE {8}; // font size of text on screen
 constexpr bool DEBUG_INFO_ENABLED {true}; // flag to toggle whether to show text on screen or not
 constexpr float ANIMATION_SENSITIVITY{1.f}; // amount to change animation speed by on key press
-// (NOTE: Changing the scale requires the convex hull models for the clusters to be regenerated)
+// (NOTE: Changing the scale rebuilds the paper & convex hull caches on the next run)
 constexpr float SCALE {5.0}; // scalar value to scale raw coordinates from csv by
-int MAX_BARS{40}; // maximum amount of bars to display
-// cluster depth for rendering
-constexpr int CLUSTER_DEPTH {6}; // amount of clusters is 2^CLUSTER_DEPTH, so 2:4, 3:8, 4:16, 5:32, 6:64
+constexpr const char* PAPERS_PATH {"data/papers_with_labels.csv"}; // papers (with cluster labels) to load, caches are written next to it
+int requestedBars{40}; // amount of bars to display (M/N keys), kept across depths & capped by numClusters when drawn
+constexpr std::size_t INITIAL_INSTANCE_CAPACITY {1 << 16}; // papers the instance buffer has room for before it grows
+// cluster depth for rendering (global for callbacks), 2-6 are precomputed (2^depth clusters, so 2:4, 3:8, 4:16, 5:32, 6:64)
+// & KMEANS_CLUSTER_DEPTH has the clusters computed in the app
+int clusterDepth {MAX_CLUSTER_DEPTH};
+int numClusters {64}; // number of clusters at clusterDepth (the bar chart shows at most this many)
+bool depthChanged {false}; // set by the key callback, bars & passed clusters are counted again
+// k-means settings (global for callbacks)
+int kmeansK {64}; // number of clusters k-means looks for
+int kmeansSpace {CLUSTER_SPACE_3D}; // positions k-means clusters
+bool kmeansRequested {false}; // set by the key callback, k-means runs in the background
+bool kmeansAvailable {false}; // true once k-means clusters have been generated
 
 // animation tweaks
 float ANIMATION_SPEED {0.f};
+constexpr float SCRUB_STEP {0.05f}; // fraction of the papers the left/right arrows jump the animation by
+int scrubSteps {0}; // set by the key callback, jumps are applied once per frame
+bool scrubbingBack {false}; // left arrow is held, explored hulls that lost papers wait until it's released
 
 // view mode: default is all shown, unseen hidden is unexplored clusters hidden, and hidden is no clusters
 enum VIEW_MODE
@@ -41,6 +61,23 @@ enum VIEW_MODE
 // view mode (global for callbacks)
 int viewMode{CLUSTERS_DEFAULT};
 
+// how papers are drawn: instanced cubes (36 vertices each) or sphere impostors (one quad each, ray cast per fragment)
+enum PAPER_MODE
+{
+    PAPERS_CUBES,
+    PAPERS_SPHERES,
+};
+// paper mode (global for callbacks)
+int paperMode{PAPERS_CUBES};
+constexpr float SPHERE_RADIUS {0.5f}; // radius of the sphere impostors (same as the cubes' half size)
+constexpr float PAPER_CULL_MARGIN {0.87f}; // octree boxes are padded by half the diagonal of a paper cube
+constexpr float LOD_SPLAT_PIXELS {16.0f}; // octree nodes at most this many pixels across are drawn as a single splat
+bool lodEnabled {true}; // level of detail (global for callbacks)
+constexpr int NUM_PAPER_TIMERS {4}; // gpu timer queries of the paper draw in flight, read back a few frames later
+// picking (global for callbacks)
+bool cursorToggled {false}; // set by the key callback, frees the cursor to pick papers (or gives it back to the camera)
+bool selectRequested {false}; // set by the mouse button callback, the picked paper is selected
+
 enum BAR_MODE
 {
     BARS_FULL, // show proportion of papers across clusters
@@ -49,27 +86,29 @@ enum BAR_MODE
 // bar mode (global for callbacks)
 int barMode{BARS_FULL};
 
-// convert from wstring (wide-string) to regular standard string
-void wstring2string(const std::wstring& ws, std::string& s);
 // glfw keycallback to handle interactivity
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+// glfw mouse button callback to select papers
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 // gets string format for VIEW_MODe enum
 std::string getViewMode();
+// gets string format for PAPER_MODE enum
+std::string getPaperMode(int mode);
 
 int main()
 {
     // load papers
     PaperLoader paperLoader{};
-    paperLoader.loadFromFile("data/papers_with_labels.csv", SCALE);
-    paperLoader.generateClusters(); // group papers into clusters
-
-    std::cout << "Loaded papers!\n";
+    // maps data/papers_with_labels.csv.pvcache if it's up to date, otherwise the csv is parsed on a background thread
+    // and papers are added (& grouped into clusters) batch by batch in the main loop
+    paperLoader.startStreaming(PAPERS_PATH, SCALE);
 
     // ---- OpenGL ---- //
     // initialize opengl wrapper
     App app{640, 640, "OpenGL window"};
     // for keyboard interactivity
     glfwSetKeyCallback(app.getWindow(), key_callback);
+    glfwSetMouseButtonCallback(app.getWindow(), mouse_button_callback);
     app.enableDepthTesting(); // IMPORTANT
     // first person camera
     app.setCameraEnabled(true);
@@ -81,21 +120,25 @@ int main()
     // glLineWidth(5.0f);
     // glEnable(GL_CULL_FACE);
 
-    // load coordinates from papers
-    std::vector<float> paperData;
-    paperLoader.getVertices(paperData);
+    // load instances from papers (more are appended while streaming)
+    std::vector<PaperInstance> paperData;
+    InstanceBounds instanceBounds{};
+    paperLoader.getInstances(paperData, instanceBounds);
 
-    // generate convex hull models from clusters (saved at data/cluster_models/)
+    // convex hull models of the clusters (cached in data/papers_with_labels.csv.pvhulls)
     Clusters::ClusterRenderer clusterRenderer{};
-    // // generates .obj file of convex hull for each cluster
-    // clusterRenderer.generateClusters(paperLoader.getClustersFull());
-    clusterRenderer.loadClusters(paperLoader.getClustersFull()); // load convex hulls
+    // convex hulls are loaded once all the papers are in (cluster centroids are needed for sorting)
+    bool clustersLoaded{false};
 
-    // generate vbo for paper instances (offset xyz, included flag, counter)
+    // generate vbo for paper instances (quantized offset xyz, flags, order index)
+    // the buffer grows (doubles) as papers are streamed in, new papers are uploaded with glBufferSubData
     unsigned int instanceVBO;
+    std::size_t instanceCapacity {std::max<std::size_t>(paperData.size(), INITIAL_INSTANCE_CAPACITY)}; // in instances
+    std::size_t numUploaded {paperData.size()}; // in instances
     glGenBuffers(1, &instanceVBO);
     glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(paperData.size() * sizeof(paperData[0])), paperData.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instanceCapacity * sizeof(PaperInstance)), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(paperData.size() * sizeof(PaperInstance)), paperData.data());
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     // create vertex array and vertex buffer for paper cubes
@@ -115,19 +158,71 @@ int main()
     // set instance data
     glEnableVertexAttribArray(2);
     glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), reinterpret_cast<void*>(0));
+    // position is normalized to [0, 1] within the instance bounds, flags & order stay integers
+    glVertexAttribPointer(2, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PaperInstance), reinterpret_cast<void*>(offsetof(PaperInstance, pos)));
     glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), reinterpret_cast<void*>(3 * sizeof(float)));
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_SHORT, sizeof(PaperInstance), reinterpret_cast<void*>(offsetof(PaperInstance, flags)));
     glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, 5 * sizeof(float), reinterpret_cast<void*>(4 * sizeof(float)));
+    glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(PaperInstance), reinterpret_cast<void*>(offsetof(PaperInstance, order)));
     glVertexAttribDivisor(2, 1); // update this index every 1th instance
     glVertexAttribDivisor(3, 1); // "" ""
     glVertexAttribDivisor(4, 1); // "" ""
 
+    // papers are sorted spatially once they're all in, so only the ranges of instances in view are drawn
+    PaperOctree paperOctree{};
+    std::vector<DrawRange> drawRanges;
+    std::size_t numDrawn{0}; // papers in the visible ranges last frame
+    // distant nodes are drawn as one splat each (level of detail)
+    std::vector<std::uint32_t> splatNodes;
+    std::vector<PaperSplat> splatData;
+
     // load papers shader
     const Shader pointShader{"shaders/pointsLighting.vert", "shaders/pointsLighting.frag"};
     // shader.addGeometryShader("shaders/points.geom");
 
+    // sphere impostors read the instance buffer as plain vertices (one per paper)
+    const Shader sphereShader{"shaders/paperSphere.vert", "shaders/paperSphere.geom", "shaders/paperSphere.frag"};
+    unsigned int sphereVAO;
+    glGenVertexArrays(1, &sphereVAO);
+    glBindVertexArray(sphereVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PaperInstance), reinterpret_cast<void*>(offsetof(PaperInstance, pos)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_SHORT, sizeof(PaperInstance), reinterpret_cast<void*>(offsetof(PaperInstance, flags)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(PaperInstance), reinterpret_cast<void*>(offsetof(PaperInstance, order)));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+
+    // splats are written every frame (point sprites, they're only a few pixels across)
+    const Shader splatShader{"shaders/paperSplat.vert", "shaders/paperSplat.frag"};
+    unsigned int splatVAO, splatVBO;
+    glGenVertexArrays(1, &splatVAO);
+    glGenBuffers(1, &splatVBO);
+    glBindVertexArray(splatVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, splatVBO);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(PaperSplat), reinterpret_cast<void*>(offsetof(PaperSplat, center)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(PaperSplat), reinterpret_cast<void*>(offsetof(PaperSplat, included)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // papers are picked by drawing their order index around the cursor (cubes or spheres, like they're shown)
+    const Shader pickShader{"shaders/paperPick.vert", "shaders/paperPick.frag"};
+    const Shader spherePickShader{"shaders/paperSphere.vert", "shaders/paperSphere.geom", "shaders/paperSpherePick.frag"};
+    PaperPicker paperPicker{};
+    paperPicker.init();
+    int selectedPaper{-1}; // order index of the paper clicked last, -1 if none
+
+    // gpu time of the paper draw for each mode, results are only read once they're available so nothing stalls
+    unsigned int paperTimers[NUM_PAPER_TIMERS];
+    glGenQueries(NUM_PAPER_TIMERS, paperTimers);
+    int paperTimerModes[NUM_PAPER_TIMERS];
+    std::fill(std::begin(paperTimerModes), std::end(paperTimerModes), -1); // -1 if the query wasn't issued
+    int paperTimer{0};
+    double paperDrawTimes[2] {0.0, 0.0}; // in ms, smoothed, per PAPER_MODE
+
     // post-processing shader
     const Shader screenShader{"shaders/builtin/screenShader.vert", "shaders/builtin/screenShader.frag"};
     const Shader uiShader {"shaders/builtin/screenShader.vert", "shaders/ui.frag"};
@@ -142,36 +237,199 @@ int main()
     // cluster shader
     const Shader clusterShader{"shaders/cluster.vert", "shaders/cluster.frag"};
 
-    std::vector<int> passedClusters{};
+    // clusters the animation has passed (one bit per cluster id), rebuilt when the current paper or the depth changes
+    std::vector<bool> passedClusters{};
+    std::size_t passedPaper {std::numeric_limits<std::size_t>::max()}; // current paper passedClusters is for
+    int numFullyExplored{0}; // clusters whose papers have all been passed
     int lastPaperIndex{0};
 
     std::cout << "Successfully initialized!\n";
 
     // data for bar chart
     std::map<int, Bar> bars{};
-    std::map paperClusters{paperLoader.getClusters(CLUSTER_DEPTH)};
-    // create a bar for each cluster
-    for (int b {0}; b < std::pow(2, CLUSTER_DEPTH); ++b)
+    // create a bar for each cluster (labels & totals are updated as papers are streamed in)
+    for (int b {0}; b < numClusters; ++b)
     {
-        std::string name;
-        wstring2string(paperClusters[b].label, name);
-        bars[b] = Bar{
-            0.0f,
-            0,
-            b,
-            std::move(name),
-            paperClusters[b].num_papers
-        };
+        bars[b] = Bar{0.0f, 0, b, "", 0};
     }
+    const auto updateBars = [&bars, &paperLoader]() {
+        const std::span<const Cluster> clusters {paperLoader.getClusters(clusterDepth)};
+        for (int b{0}; b < static_cast<int>(clusters.size()); ++b)
+        {
+            const Cluster& cluster {clusters[b]};
+            if (cluster.num_papers == 0)
+            {
+                continue;
+            }
+            if (bars[b].name.empty())
+            {
+                bars[b].clusterIdx = b;
+                bars[b].name = cluster.label;
+            }
+            bars[b].totalPapers = cluster.num_papers;
+        }
+        numClusters = std::max(numClusters, static_cast<int>(clusters.size()));
+    };
+    updateBars();
 
     // counter to keep track of num. papers
     int numPapers{0};
     float animationProgress{0.f};
+    // explored papers per cluster, looked up in the exploration index (the cluster members) for any progress
+    std::vector<ExploredCount> exploredCounts{};
+    // bars of papers [0, lastPaperIndex) at clusterDepth, counted again when the animation goes back or jumps,
+    // or the depth changes
+    const auto countExploredPapers = [&bars, &lastPaperIndex, &numPapers, &exploredCounts, &paperLoader]() {
+        for (std::pair<const int, Bar>& bar : bars)
+        {
+            bar.second.numPapers = 0;
+            bar.second.numIncluded = 0;
+            bar.second.numNotIncluded = 0;
+        }
+        numPapers = lastPaperIndex;
+        // O(clusters * log(papers)) once all papers are loaded
+        paperLoader.getExploredCounts(clusterDepth, static_cast<std::size_t>(lastPaperIndex), exploredCounts);
+        if (!exploredCounts.empty())
+        {
+            for (int c{0}; c < static_cast<int>(exploredCounts.size()); ++c)
+            {
+                if (exploredCounts[c].numPapers == 0)
+                {
+                    continue;
+                }
+                Bar& bar {bars[c]};
+                bar.numPapers = exploredCounts[c].numPapers;
+                bar.numIncluded = exploredCounts[c].numIncluded;
+                bar.numNotIncluded = exploredCounts[c].numPapers - exploredCounts[c].numIncluded;
+            }
+            return;
+        }
+        // still streaming, so go through the papers
+        const std::span<const std::uint16_t> paperClusterIDs {paperLoader.getClusterIDs(clusterDepth)};
+        for (int i{0}; i < lastPaperIndex; ++i)
+        {
+            const int paperCluster {paperClusterIDs[i]};
+            ++bars[paperCluster].numPapers;
+            if (paperLoader.getPapers().isIncluded(i))
+            {
+                ++bars[paperCluster].numIncluded;
+            } else {
+                ++bars[paperCluster].numNotIncluded;
+            }
+        }
+    };
+
+    // k-means runs on its own thread (its steps use the worker pool), the result is applied on the main thread
+    std::future<KMeans::Result> kmeansTask{};
+    auto kmeansStart {std::chrono::steady_clock::now()};
+
+    // draw the visible ranges of papers as cubes or spheres (the shader is set up by the caller)
+    auto drawPaperRanges = [&](const int mode) {
+        if (mode == PAPERS_SPHERES)
+        {
+            glBindVertexArray(sphereVAO);
+            for (const DrawRange& range : drawRanges)
+            {
+                glDrawArrays(GL_POINTS, static_cast<int>(range.first), static_cast<int>(range.count));
+            }
+            return;
+        }
+        glBindVertexArray(VAO);
+        // no base instance in GL 4.1, so the instance attributes point at the first paper of each range
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (const DrawRange& range : drawRanges)
+        {
+            const std::size_t offset {range.first * sizeof(PaperInstance)};
+            glVertexAttribPointer(2, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PaperInstance), reinterpret_cast<void*>(offset + offsetof(PaperInstance, pos)));
+            glVertexAttribIPointer(3, 1, GL_UNSIGNED_SHORT, sizeof(PaperInstance), reinterpret_cast<void*>(offset + offsetof(PaperInstance, flags)));
+            glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(PaperInstance), reinterpret_cast<void*>(offset + offsetof(PaperInstance, order)));
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 36, static_cast<int>(range.count));
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    };
 
     // main loop
     while (!app.shouldClose())
     {
+        // add papers parsed since last frame & upload their instance data
+        if (paperLoader.pollBatches())
+        {
+            if (paperLoader.appendInstances(paperData, instanceBounds))
+            {
+                // papers outside the bounds, so all instances were quantized again
+                numUploaded = 0;
+            }
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            if (paperData.size() > instanceCapacity)
+            {
+                // reallocate & upload everything (the vao keeps pointing at the same buffer object)
+                instanceCapacity = std::max(paperData.size(), instanceCapacity * 2);
+                glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instanceCapacity * sizeof(PaperInstance)), nullptr, GL_DYNAMIC_DRAW);
+                numUploaded = 0;
+            }
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(numUploaded * sizeof(PaperInstance)),
+                            static_cast<GLsizeiptr>((paperData.size() - numUploaded) * sizeof(PaperInstance)), paperData.data() + numUploaded);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            numUploaded = paperData.size();
+            updateBars();
+        }
+        if (!clustersLoaded && !paperLoader.isStreaming())
+        {
+            clusterRenderer.loadClusters(paperLoader, PAPERS_PATH); // load (or build) convex hulls
+            clustersLoaded = true;
+            std::cout << "Loaded papers!\n";
+        }
+        // the instances are reordered, so everything is uploaded again
+        if (!paperLoader.isStreaming() && paperOctree.getNumInstances() != paperData.size())
+        {
+            paperOctree.build(paperData, instanceBounds);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(paperData.size() * sizeof(PaperInstance)), paperData.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            std::cout << "Built paper octree (" << paperOctree.getNodes().size() << " nodes)\n";
+        }
+        // k-means needs all the papers, which don't change while it's running (a request made while loading or
+        // while k-means is running is kept until it can start)
+        if (kmeansRequested && clustersLoaded && !kmeansTask.valid())
+        {
+            std::cout << "Running k-means (k = " << kmeansK << ", " << (kmeansSpace == CLUSTER_SPACE_2D ? "2D" : "3D") << ")...\n";
+            kmeansStart = std::chrono::steady_clock::now();
+            kmeansTask = std::async(std::launch::async, [&paperLoader, k = kmeansK, space = static_cast<ClusterSpace>(kmeansSpace)] {
+                return paperLoader.runKMeans(k, space);
+            });
+            kmeansRequested = false;
+        }
+        if (kmeansTask.valid() && kmeansTask.wait_for(std::chrono::seconds{0}) == std::future_status::ready)
+        {
+            paperLoader.setKMeansClusters(kmeansTask.get());
+            clusterRenderer.loadClusterLevel(paperLoader, KMEANS_CLUSTER_DEPTH);
+            const std::chrono::duration<double, std::milli> time {std::chrono::steady_clock::now() - kmeansStart};
+            std::cout << "Generated k-means clusters (" << time.count() << " ms)" << std::endl;
+            kmeansAvailable = paperLoader.hasKMeansClusters();
+            // show the new clusters
+            clusterDepth = KMEANS_CLUSTER_DEPTH;
+            depthChanged = true;
+        }
+        if (depthChanged)
+        {
+            if (clusterDepth == KMEANS_CLUSTER_DEPTH && !kmeansAvailable)
+            {
+                clusterDepth = MIN_CLUSTER_DEPTH;
+            }
+            bars.clear();
+            numClusters = static_cast<int>(paperLoader.getClusters(clusterDepth).size());
+            updateBars();
+            countExploredPapers();
+            passedPaper = std::numeric_limits<std::size_t>::max();
+            depthChanged = false;
+        }
+
         // refresh keyboard events
+        if (cursorToggled)
+        {
+            app.setCameraEnabled(!app.getCameraEnabled());
+            cursorToggled = false;
+        }
         app.handleInput();
         app.enablePostProcessing(); // write to framebuffer
         // ---- do rendering ---- //
@@ -179,19 +437,125 @@ int main()
 
         // ------------------------ //
 
-        // Render the points (cubes)
-        // The cubes are rendered instanced to improve performance
-        pointShader.use();
-        pointShader.setMat4("projection", app.getPerspectiveMatrix());
-        pointShader.setMat4("view", app.getViewMatrix());
-        pointShader.setMat4("model", glm::mat4(1.0f));
-        pointShader.setVec3("camerapos", app.getCameraPosition());
-        pointShader.setFloat("time", animationProgress);
-        pointShader.setInt("lastIndex", static_cast<int>(paperLoader.getLastIndex()));
-        glBindVertexArray(VAO);
-        // there are five pieces of data per instance (5 * sizeof(float)), so number of instances = paperData.size() / 5
-        // not paperData.size()
-        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, static_cast<int>(paperData.size() / 5));
+        // collect the timer query issued NUM_PAPER_TIMERS frames ago (if it's done) & time this frame's draw
+        const int mode {paperTimerModes[paperTimer]};
+        int timerAvailable{0};
+        if (mode >= 0)
+        {
+            glGetQueryObjectiv(paperTimers[paperTimer], GL_QUERY_RESULT_AVAILABLE, &timerAvailable);
+        }
+        if (mode < 0 || timerAvailable != 0)
+        {
+            if (mode >= 0)
+            {
+                GLuint64 elapsed{0};
+                glGetQueryObjectui64v(paperTimers[paperTimer], GL_QUERY_RESULT, &elapsed);
+                const double elapsedMs {static_cast<double>(elapsed) / 1000000.0};
+                paperDrawTimes[mode] = paperDrawTimes[mode] == 0.0 ? elapsedMs : paperDrawTimes[mode] * 0.9 + elapsedMs * 0.1;
+            }
+            glBeginQuery(GL_TIME_ELAPSED, paperTimers[paperTimer]);
+        }
+        // papers with an order index below this have been explored (order < time, exact for any number of papers)
+        const unsigned int numExplored {static_cast<unsigned int>(std::ceil(std::max(0.0f, animationProgress)))};
+        // ranges of papers in view & splats of the distant nodes, papers streamed in after the octree was built are always drawn
+        const float pixelScale {app.getPerspectiveMatrix()[1][1] * static_cast<float>(app.getHeight()) / 2.0f};
+        paperOctree.cull(app.getPerspectiveMatrix() * app.getViewMatrix(), PAPER_CULL_MARGIN, pixelScale,
+                         lodEnabled ? LOD_SPLAT_PIXELS : 0.0f, drawRanges, splatNodes);
+        if (paperData.size() > paperOctree.getNumInstances())
+        {
+            drawRanges.push_back({static_cast<std::uint32_t>(paperOctree.getNumInstances()), static_cast<std::uint32_t>(paperData.size() - paperOctree.getNumInstances())});
+        }
+        numDrawn = 0;
+        for (const DrawRange& range : drawRanges)
+        {
+            numDrawn += range.count;
+        }
+        if (paperMode == PAPERS_SPHERES)
+        {
+            // Render the papers as spheres, one camera facing quad per paper that's ray cast against the sphere
+            sphereShader.use();
+            sphereShader.setMat4("projection", app.getPerspectiveMatrix());
+            sphereShader.setMat4("view", app.getViewMatrix());
+            sphereShader.setMat4("model", glm::mat4(1.0f));
+            sphereShader.setFloat("radius", SPHERE_RADIUS);
+            sphereShader.setUInt("numExplored", numExplored);
+            sphereShader.setUInt("lastIndex", paperLoader.getLastIndex());
+            sphereShader.setVec3("boundsMin", instanceBounds.min);
+            sphereShader.setVec3("boundsSize", instanceBounds.size);
+        } else
+        {
+            // Render the points (cubes)
+            // The cubes are rendered instanced to improve performance
+            pointShader.use();
+            pointShader.setMat4("projection", app.getPerspectiveMatrix());
+            pointShader.setMat4("view", app.getViewMatrix());
+            pointShader.setMat4("model", glm::mat4(1.0f));
+            pointShader.setVec3("camerapos", app.getCameraPosition());
+            pointShader.setUInt("numExplored", numExplored);
+            pointShader.setUInt("lastIndex", paperLoader.getLastIndex());
+            pointShader.setVec3("boundsMin", instanceBounds.min);
+            pointShader.setVec3("boundsSize", instanceBounds.size);
+        }
+        drawPaperRanges(paperMode);
+        if (!splatNodes.empty())
+        {
+            // explored papers are the ones the shaders colour (up to lastIndex)
+            paperOctree.getSplats(splatNodes, std::min(numExplored, paperLoader.getLastIndex() + 1), splatData);
+            glBindBuffer(GL_ARRAY_BUFFER, splatVBO);
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(splatData.size() * sizeof(PaperSplat)), splatData.data(), GL_STREAM_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            splatShader.use();
+            splatShader.setMat4("projection", app.getPerspectiveMatrix());
+            splatShader.setMat4("view", app.getViewMatrix());
+            splatShader.setMat4("model", glm::mat4(1.0f));
+            splatShader.setFloat("pixelScale", pixelScale);
+            glBindVertexArray(splatVAO);
+            glDrawArrays(GL_POINTS, 0, static_cast<int>(splatData.size()));
+        }
+        if (mode < 0 || timerAvailable != 0)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+            paperTimerModes[paperTimer] = paperMode;
+        }
+        paperTimer = (paperTimer + 1) % NUM_PAPER_TIMERS;
+
+        // pick the paper under the cursor (the center of the screen while the camera has the cursor),
+        // the ids of earlier frames are read back once they're done
+        paperPicker.poll();
+        glm::vec2 cursor {static_cast<float>(app.getWidth()) / 2.0f, static_cast<float>(app.getHeight()) / 2.0f};
+        int windowWidth{0}, windowHeight{0};
+        glfwGetWindowSize(app.getWindow(), &windowWidth, &windowHeight);
+        if (!app.getCameraEnabled() && windowWidth > 0 && windowHeight > 0)
+        {
+            double cursorX{0.0}, cursorY{0.0};
+            glfwGetCursorPos(app.getWindow(), &cursorX, &cursorY);
+            // window coordinates (origin at the top left) to framebuffer pixels (origin at the bottom left)
+            cursor = glm::vec2{cursorX / windowWidth, 1.0 - cursorY / windowHeight} * glm::vec2{app.getWidth(), app.getHeight()};
+        }
+        glm::mat4 pickProjection {app.getPerspectiveMatrix()};
+        if (paperPicker.begin(cursor, app.getWidth(), app.getHeight(), pickProjection))
+        {
+            const Shader& paperPickShader {paperMode == PAPERS_SPHERES ? spherePickShader : pickShader};
+            paperPickShader.use();
+            paperPickShader.setMat4("projection", pickProjection);
+            paperPickShader.setMat4("view", app.getViewMatrix());
+            paperPickShader.setMat4("model", glm::mat4(1.0f));
+            paperPickShader.setVec3("boundsMin", instanceBounds.min);
+            paperPickShader.setVec3("boundsSize", instanceBounds.size);
+            if (paperMode == PAPERS_SPHERES)
+            {
+                paperPickShader.setFloat("radius", SPHERE_RADIUS);
+            }
+            drawPaperRanges(paperMode);
+            paperPicker.end();
+            app.enablePostProcessing(); // back to the scene framebuffer
+            glViewport(0, 0, app.getWidth(), app.getHeight());
+        }
+        if (selectRequested)
+        {
+            selectedPaper = paperPicker.getPickedPaper();
+            selectRequested = false;
+        }
 
         // ------------------------ //
 
@@ -199,26 +563,24 @@ int main()
         // progress of animation
         const float progress {std::min(animationProgress, static_cast<float>(paperLoader.getLastIndex()))};
         // current paper animation is at
-        const Paper& currentPaper {paperLoader.getPaper(progress)};
+        const std::size_t currentPaper {paperLoader.getPaperIndex(progress)};
         // current cluster the current paper is located in
-        const int currentCluster {paperLoader.getClusterID(currentPaper, CLUSTER_DEPTH)};
-        // update passed clusters
-        if (std::ranges::find(passedClusters, currentCluster) == passedClusters.end())
+        const int currentCluster {paperLoader.getClusterID(currentPaper, clusterDepth)};
+        // update all the clusters animation skipped (animation speed > 1 paper/sec)
+        const int paperIndex {static_cast<int>(progress)};
+        if (paperIndex < lastPaperIndex || (paperIndex > lastPaperIndex && !paperLoader.isStreaming()))
         {
-            passedClusters.push_back(currentCluster);
+            // going back, or all papers are in the index, so the counts are looked up instead of counted
+            lastPaperIndex = paperIndex;
+            countExploredPapers();
         }
-        // update all the clusters animation skipped (animation speed > 1 paper/sec)
-        for (int i{lastPaperIndex}; i < static_cast<int>(progress); ++i)
+        const std::span<const std::uint16_t> paperClusterIDs {paperLoader.getClusterIDs(clusterDepth)};
+        for (int i{lastPaperIndex}; i < paperIndex; ++i)
         {
-            const Paper& paperTemp {paperLoader.getPaper(static_cast<float>(i))};
-            const int paperCluster {paperLoader.getClusterID(paperTemp, CLUSTER_DEPTH)};
-            if (std::ranges::find(passedClusters, paperCluster) == passedClusters.end())
-            {
-                passedClusters.push_back(paperCluster);
-            }
+            const int paperCluster {paperClusterIDs[i]};
             // add clusters to bar chart
             ++bars[paperCluster].numPapers;
-            if (paperTemp.included)
+            if (paperLoader.getPapers().isIncluded(i))
             {
                 ++bars[paperCluster].numIncluded;
             } else {
@@ -227,7 +589,44 @@ int main()
             // increment total
             ++numPapers;
         }
-        lastPaperIndex = static_cast<int>(progress);
+        lastPaperIndex = paperIndex;
+        // update passed clusters, a cluster is passed once the current paper reaches its first paper
+        const ClusterMembers& members {paperLoader.getClusterMembersFull(clusterDepth)};
+        const std::size_t numClusterIDs {paperLoader.getClusters(clusterDepth).size()};
+        if (currentPaper != passedPaper || passedClusters.size() != numClusterIDs || paperLoader.isStreaming())
+        {
+            passedClusters.assign(numClusterIDs, false);
+            numFullyExplored = 0;
+            if (members.firstPaper.size() == numClusterIDs)
+            {
+                for (std::size_t c{0}; c < numClusterIDs; ++c)
+                {
+                    passedClusters[c] = members.firstPaper[c] <= currentPaper;
+                    numFullyExplored += members.lastPaper[c] <= currentPaper;
+                }
+            } else
+            {
+                // members are built once streaming is done, until then the bars know which clusters have papers
+                for (const std::pair<const int, Bar>& bar : bars)
+                {
+                    if (bar.second.numPapers > 0 && static_cast<std::size_t>(bar.first) < numClusterIDs)
+                    {
+                        passedClusters[bar.first] = true;
+                    }
+                }
+                // -1 if no papers have been loaded yet
+                if (currentCluster >= 0 && static_cast<std::size_t>(currentCluster) < numClusterIDs)
+                {
+                    passedClusters[currentCluster] = true;
+                }
+            }
+            passedPaper = currentPaper;
+        }
+        // grow the explored hulls to the papers the animation passed
+        if (clustersLoaded)
+        {
+            clusterRenderer.updateExploredClusters(paperLoader, clusterDepth, static_cast<std::size_t>(progress), ANIMATION_SPEED < 0.0f || scrubbingBack);
+        }
 
         // ---- Render clusters ---- //
 
@@ -241,20 +640,20 @@ int main()
         clusterShader.use();
         clusterShader.setVec3("CameraPos", app.getCameraPosition());
 
-        // iterate through clusters (n = 2^CLUSTER_DEPTH)
+        // iterate through clusters of the current depth
         std::map<float, std::pair<int, glm::vec3>> sortedClusters{};
-        for (int c {0}; c < std::pow(2, CLUSTER_DEPTH); ++c)
+        for (int c {0}; c < static_cast<int>(paperLoader.getClusters(clusterDepth).size()); ++c)
         {
             // color & idx is info needed for rendering
             glm::vec3 color;
             float distance; // info needed for sorting
             // get cluster data for position
-            const Clusters::ClusterData* clusterData {clusterRenderer.getClusterData(CLUSTER_DEPTH, c)};
+            const Clusters::ClusterData* clusterData {clusterRenderer.getClusterData(clusterDepth, c)};
             distance = glm::length(app.getCameraPosition() - clusterData->position);
             if (currentCluster == c)
             {
                 color = {0.9f, 1.0f, 0.0f};
-            } else if (std::ranges::find(passedClusters, c) != passedClusters.end())
+            } else if (passedClusters[c])
             {
                 color = {0.0f, 0.9f, 1.0f};
             } else
@@ -282,8 +681,14 @@ int main()
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
         for (std::map<float, std::pair<int, glm::vec3>>::reverse_iterator it {sortedClusters.rbegin()}; it != sortedClusters.rend(); ++it)
         {
+            // explored part of the cluster is inside its hull, so it's rendered first
+            if (viewMode != CLUSTERS_HIDDEN)
+            {
+                clusterRenderer.renderExploredCluster(clusterShader, app.getPerspectiveMatrix(), app.getViewMatrix(),
+                    glm::vec3{1.0f, 0.5f, 0.0f}, clusterDepth, it->second.first);
+            }
             clusterRenderer.renderCluster(clusterShader, app.getPerspectiveMatrix(), app.getViewMatrix(),
-                it->second.second, CLUSTER_DEPTH, it->second.first);
+                it->second.second, clusterDepth, it->second.first);
         }
 
         glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -315,6 +720,7 @@ int main()
             });
             
             // render bars
+            const int maxBars {std::min(requestedBars, numClusters)};
             int numBars{0};
             std::stringstream ss; // for percentages & cluster labesl
             for (const std::pair<int, Bar>& bar : sortedBars)
@@ -369,7 +775,7 @@ int main()
                 }
                 // cap number of bars
                 ++numBars;
-                if (numBars > MAX_BARS)
+                if (numBars > maxBars)
                 {
                     break;
                 }
@@ -421,27 +827,67 @@ int main()
             info.emplace_back(text.str());
             text.str("");
             
+            text << "Papers in view: " << numDrawn << "/" << paperData.size() << " (" << drawRanges.size() << " draws) | LOD: "
+                 << (lodEnabled ? "on" : "off") << " (" << splatNodes.size() << " splats)";
+            info.emplace_back(text.str());
+            text.str("");
+
             text << "Num. papers explored: " << paperLoader.getLastIndex();
             info.emplace_back(text.str());
             text.str("");
             text << "Num. papers unexplored: " << paperLoader.getNumPapers() - paperLoader.getLastIndex();
             info.emplace_back(text.str());
             text.str("");
+            if (paperLoader.isStreaming())
+            {
+                text << "Streaming papers... (" << paperLoader.getNumPapers() << " loaded)";
+                info.emplace_back(text.str());
+                text.str("");
+            }
             
-            text << "Current cluster depth: " << CLUSTER_DEPTH;
+            if (clusterDepth == KMEANS_CLUSTER_DEPTH)
+            {
+                text << "Current cluster depth: k-means (k = " << numClusters << ")";
+            } else
+            {
+                text << "Current cluster depth: " << clusterDepth;
+            }
+            info.emplace_back(text.str());
+            text.str("");
+
+            text << "k-means: k = " << kmeansK << " (" << (kmeansSpace == CLUSTER_SPACE_2D ? "2D" : "3D") << ")" << (kmeansTask.valid() ? ", running..." : "");
             info.emplace_back(text.str());
             text.str("");
             
-            std::wstring clusterLabel {paperLoader.getClusterLabel(currentPaper, CLUSTER_DEPTH)};
-            std::string label;
-            wstring2string(clusterLabel, label);
-            text << "Current cluster label: " << label;
+            text << "Current cluster label: " << paperLoader.getClusterLabel(currentPaper, clusterDepth);
             info.emplace_back(text.str());
             text.str("");
             
-            text << "Current cluster ID: " << paperLoader.getClusterID(currentPaper, CLUSTER_DEPTH);
+            text << "Current cluster ID: " << paperLoader.getClusterID(currentPaper, clusterDepth);
             info.emplace_back(text.str());
             text.str("");
+
+            text << "Clusters passed: " << std::ranges::count(passedClusters, true) << " (" << numFullyExplored << " fully explored)";
+            info.emplace_back(text.str());
+            text.str("");
+
+            // coarser cluster the current one is part of & its finer sub-clusters (precomputed depths only)
+            const ClusterTree& clusterTree {paperLoader.getClusterTree()};
+            const int currentNode {clusterTree.getNodeIndex(clusterDepth, currentCluster)};
+            if (currentNode >= 0)
+            {
+                const ClusterNode& node {clusterTree.getNode(currentNode)};
+                if (node.parent >= 0)
+                {
+                    const ClusterNode& parent {clusterTree.getNode(node.parent)};
+                    text << "Parent cluster: " << paperLoader.getClusters(parent.depth)[parent.id].label << " (" << parent.numPapers << " papers)";
+                    info.emplace_back(text.str());
+                    text.str("");
+                }
+                text << "Sub-clusters: " << node.numChildren << " | " << node.numIncluded << "/" << node.numPapers << " papers included";
+                info.emplace_back(text.str());
+                text.str("");
+            }
             
             
             for (int i {0}; i < info.size(); ++i)
@@ -449,13 +895,29 @@ int main()
                 fontManager.renderText(fontShader, info[i], 10.0f, static_cast<float>(app.getHeight() - 25 - 15 * i), 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
             }
             
-            std::string paperTitle;
-            wstring2string(currentPaper.title, paperTitle);
+            // papers under the cursor & clicked last (order index is the paper index)
+            const int hoveredPaper {paperPicker.getPickedPaper()};
+            if (hoveredPaper >= 0 && static_cast<std::size_t>(hoveredPaper) < paperLoader.getNumPapers())
+            {
+                text << "Hovered paper: " << paperLoader.getPapers().getTitle(hoveredPaper);
+                fontManager.renderText(fontShader, text.str(), 5.0f, 65.0f, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
+                text.str("");
+            }
+            if (selectedPaper >= 0 && static_cast<std::size_t>(selectedPaper) < paperLoader.getNumPapers())
+            {
+                text << "Selected paper: " << paperLoader.getPapers().getTitle(selectedPaper);
+                fontManager.renderText(fontShader, text.str(), 5.0f, 50.0f, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
+                text.str("");
+            }
+
+            // title is a view into the paper text arena (utf-8), so nothing is converted or copied
+            const std::string_view paperTitle {currentPaper < paperLoader.getNumPapers() ? paperLoader.getPapers().getTitle(currentPaper) : std::string_view{}};
             text << "Current paper title: " << paperTitle;
             fontManager.renderText(fontShader, text.str(), 5.0f, 5.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
             text.str("");
             
-            text << "View mode: " << getViewMode();
+            text << "View mode: " << getViewMode() << " | Papers: " << getPaperMode(paperMode) << " (GPU " << getPaperMode(PAPERS_CUBES) << " "
+                 << paperDrawTimes[PAPERS_CUBES] << " ms, " << getPaperMode(PAPERS_SPHERES) << " " << paperDrawTimes[PAPERS_SPHERES] << " ms)";
             fontManager.renderText(fontShader, text.str(), 5.0f, 20.0f, 1.0f, glm::vec3(1.0f, 1.0f, 1.0f));
             text.str("");
             
@@ -476,11 +938,19 @@ int main()
         app.tick();
         // animation is updated at constant speed
         animationProgress += ANIMATION_SPEED * app.getDeltaTime();
+        // jump forward or back
+        animationProgress += static_cast<float>(scrubSteps) * SCRUB_STEP * static_cast<float>(paperLoader.getNumPapers());
+        scrubSteps = 0;
         // clamp animation progress to avoid user messing it up
         animationProgress = std::max(0.0f, std::min(static_cast<float>(paperLoader.getNumPapers() - 1), animationProgress));
     }
 
     // clean up
+    paperPicker.free();
+    glDeleteQueries(NUM_PAPER_TIMERS, paperTimers);
+    glDeleteVertexArrays(1, &splatVAO);
+    glDeleteBuffers(1, &splatVBO);
+    glDeleteVertexArrays(1, &sphereVAO);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &instanceVBO);
@@ -489,16 +959,6 @@ int main()
     return EXIT_SUCCESS;
 }
 
-void wstring2string(const std::wstring& ws, std::string& s)
-{
-    const std::size_t len {std::wcstombs(nullptr, ws.c_str(), 0) + 1};
-    // buffer to hold multibyte string
-    char* buffer {new char[len]};
-    wcstombs(buffer, ws.c_str(), len);
-    s = buffer;
-    delete[] buffer;
-}
-
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
     // switch between different view modes
@@ -511,15 +971,58 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     {
         barMode = (barMode + 1) % 2;
     }
+    // free the cursor to hover & click papers (the camera stops until it's pressed again)
+    if (key == GLFW_KEY_TAB && action == GLFW_PRESS)
+    {
+        cursorToggled = true;
+    }
+    // toggle level of detail (distant papers drawn as splats)
+    if (key == GLFW_KEY_O && action == GLFW_PRESS)
+    {
+        lodEnabled = !lodEnabled;
+    }
+    // toggle drawing papers as cubes or spheres
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        paperMode = (paperMode + 1) % 2;
+    }
 
     if (key == GLFW_KEY_M && (action == GLFW_REPEAT || action == GLFW_PRESS))
     {
-        MAX_BARS = std::max(0, std::min(static_cast<int>(std::pow(2, CLUSTER_DEPTH)), ++MAX_BARS));
+        // a request above the number of clusters (from a deeper level) is kept
+        if (requestedBars < numClusters)
+        {
+            ++requestedBars;
+        }
     }
 
     if (key == GLFW_KEY_N && (action == GLFW_REPEAT || action == GLFW_PRESS))
     {
-        MAX_BARS = std::max(0, std::min(static_cast<int>(std::pow(2, CLUSTER_DEPTH)), --MAX_BARS));
+        requestedBars = std::max(0, std::min(numClusters, requestedBars) - 1);
+    }
+
+    // cycle cluster depths (2-6, then the k-means clusters once they've been generated)
+    if (key == GLFW_KEY_L && action == GLFW_PRESS)
+    {
+        const int maxDepth {kmeansAvailable ? KMEANS_CLUSTER_DEPTH : MAX_CLUSTER_DEPTH};
+        clusterDepth = clusterDepth >= maxDepth ? MIN_CLUSTER_DEPTH : clusterDepth + 1;
+        depthChanged = true;
+    }
+    // run k-means with the current k & space
+    if (key == GLFW_KEY_K && action == GLFW_PRESS)
+    {
+        kmeansRequested = true;
+    }
+    // change k (shift for steps of 10)
+    if ((key == GLFW_KEY_LEFT_BRACKET || key == GLFW_KEY_RIGHT_BRACKET) && (action == GLFW_REPEAT || action == GLFW_PRESS))
+    {
+        const int step {(mods & GLFW_MOD_SHIFT) != 0 ? 10 : 1};
+        kmeansK = std::max(1, std::min(KMeans::MAX_CLUSTERS, kmeansK + (key == GLFW_KEY_RIGHT_BRACKET ? step : -step)));
+    }
+    // toggle clustering the 3D or 2D positions
+    if (key == GLFW_KEY_V && action == GLFW_PRESS)
+    {
+        kmeansSpace = kmeansSpace == CLUSTER_SPACE_3D ? CLUSTER_SPACE_2D : CLUSTER_SPACE_3D;
     }
 
     // increase animation speed
@@ -532,8 +1035,17 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     if (key == GLFW_KEY_DOWN && (action == GLFW_REPEAT || action == GLFW_PRESS))
     {
         ANIMATION_SPEED -= ANIMATION_SENSITIVITY;
-        // limit to positive values for now
-        ANIMATION_SPEED = std::max(0.f, ANIMATION_SPEED); // TODO: Fix this
+        // negative speeds play the animation backwards
+    }
+
+    // scrub through the animation
+    if ((key == GLFW_KEY_LEFT || key == GLFW_KEY_RIGHT) && (action == GLFW_REPEAT || action == GLFW_PRESS))
+    {
+        scrubSteps += key == GLFW_KEY_RIGHT ? 1 : -1;
+    }
+    if (key == GLFW_KEY_LEFT)
+    {
+        scrubbingBack = action != GLFW_RELEASE;
     }
 }
 
@@ -550,4 +1062,25 @@ std::string getViewMode()
         default:
             return "CLUSTERS_DEFAULT";
     };
-}
\ No newline at end of file
+}
+
+void mouse_button_callback(GLFWwindow*, int button, int action, int)
+{
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+    {
+        selectRequested = true;
+    }
+}
+
+std::string getPaperMode(const int mode)
+{
+    switch (mode)
+    {
+        case PAPERS_CUBES:
+            return "cubes";
+        case PAPERS_SPHERES:
+            return "spheres";
+        default:
+            return "cubes";
+    };
+}
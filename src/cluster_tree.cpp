@@ -0,0 +1,194 @@
+#include "cluster_tree.h"
+
+#include "paper_loader.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <future>
+
+// tables with at least this many papers build their levels on the worker pool
+constexpr std::size_t MIN_PARALLEL_TREE_PAPERS {1 << 16};
+
+void ClusterTree::build(const PaperTable& papers, const std::span<const ClusterMembers> members)
+{
+    clear();
+    m_levelOffsets.push_back(0);
+    for (int depth{MIN_CLUSTER_DEPTH}; depth <= MAX_CLUSTER_DEPTH; ++depth)
+    {
+        const std::vector<std::uint32_t>& offsets {members[depth - MIN_CLUSTER_DEPTH].offsets};
+        const std::size_t numClusters {offsets.empty() ? 0 : offsets.size() - 1};
+        for (std::size_t id{0}; id < numClusters; ++id)
+        {
+            m_nodes.push_back({depth, static_cast<int>(id)});
+        }
+        m_levelOffsets.push_back(static_cast<std::uint32_t>(m_nodes.size()));
+    }
+
+    // levels only write their own nodes
+    ThreadPool& pool {ThreadPool::shared()};
+    if (pool.size() > 1 && papers.size() >= MIN_PARALLEL_TREE_PAPERS)
+    {
+        std::vector<std::future<void>> tasks;
+        for (int depth{MIN_CLUSTER_DEPTH}; depth <= MAX_CLUSTER_DEPTH; ++depth)
+        {
+            tasks.push_back(pool.submit([this, &papers, members, depth] { buildLevel(papers, members, depth); }));
+        }
+        for (std::future<void>& task : tasks)
+        {
+            task.get();
+        }
+    } else
+    {
+        for (int depth{MIN_CLUSTER_DEPTH}; depth <= MAX_CLUSTER_DEPTH; ++depth)
+        {
+            buildLevel(papers, members, depth);
+        }
+    }
+
+    // children grouped by parent (counting sort, so they stay in cluster id order)
+    std::vector<std::uint32_t> next(m_nodes.size(), 0);
+    for (const ClusterNode& node : m_nodes)
+    {
+        if (node.parent >= 0)
+        {
+            ++m_nodes[node.parent].numChildren;
+        }
+    }
+    std::uint32_t first{0};
+    for (std::size_t n{0}; n < m_nodes.size(); ++n)
+    {
+        m_nodes[n].firstChild = first;
+        next[n] = first;
+        first += m_nodes[n].numChildren;
+    }
+    m_children.resize(first);
+    for (std::size_t n{0}; n < m_nodes.size(); ++n)
+    {
+        if (m_nodes[n].parent >= 0)
+        {
+            m_children[next[m_nodes[n].parent]++] = static_cast<std::uint32_t>(n);
+        }
+    }
+}
+
+void ClusterTree::buildLevel(const PaperTable& papers, const std::span<const ClusterMembers> members, const int depth)
+{
+    const ClusterMembers& level {members[depth - MIN_CLUSTER_DEPTH]};
+    const std::span<const glm::vec3> positions {papers.getPositions3D()};
+    // parents are looked up by the cluster ids of the coarser depth
+    const bool hasParents {depth > MIN_CLUSTER_DEPTH};
+    const std::span<const std::uint16_t> parentIDs {hasParents ? papers.getClusterIDs(depth - 1) : std::span<const std::uint16_t>{}};
+    const std::uint32_t parentOffset {hasParents ? m_levelOffsets[depth - 1 - MIN_CLUSTER_DEPTH] : 0};
+    const std::size_t numParents {hasParents ? m_levelOffsets[depth - MIN_CLUSTER_DEPTH] - parentOffset : 0};
+    std::vector<std::uint32_t> counts(numParents, 0);
+
+    const std::uint32_t levelOffset {m_levelOffsets[depth - MIN_CLUSTER_DEPTH]};
+    for (std::size_t id{0}; id + 1 < level.offsets.size(); ++id)
+    {
+        ClusterNode& node {m_nodes[levelOffset + id]};
+        const std::span<const std::uint32_t> papersOf {std::span<const std::uint32_t>{level.indices}.subspan(level.offsets[id], level.offsets[id + 1] - level.offsets[id])};
+        node.numPapers = static_cast<int>(papersOf.size());
+        if (papersOf.empty())
+        {
+            continue;
+        }
+        node.min = positions[papersOf.front()];
+        node.max = node.min;
+        for (const std::uint32_t paper : papersOf)
+        {
+            node.numIncluded += papers.isIncluded(paper);
+            node.min = glm::min(node.min, positions[paper]);
+            node.max = glm::max(node.max, positions[paper]);
+            if (hasParents && parentIDs[paper] < numParents)
+            {
+                ++counts[parentIDs[paper]];
+            }
+        }
+        if (numParents == 0)
+        {
+            continue;
+        }
+        // most common parent (lowest id on ties), counts are reset for the next cluster
+        std::uint32_t parent{0};
+        for (const std::uint32_t paper : papersOf)
+        {
+            const std::uint16_t candidate {parentIDs[paper]};
+            if (candidate < numParents && (counts[candidate] > counts[parent] || (counts[candidate] == counts[parent] && candidate < parent)))
+            {
+                parent = candidate;
+            }
+        }
+        if (counts[parent] > 0)
+        {
+            node.parent = static_cast<int>(parentOffset + parent);
+            node.numInParent = static_cast<int>(counts[parent]);
+        }
+        for (const std::uint32_t paper : papersOf)
+        {
+            if (parentIDs[paper] < numParents)
+            {
+                counts[parentIDs[paper]] = 0;
+            }
+        }
+    }
+}
+
+void ClusterTree::clear()
+{
+    m_nodes.clear();
+    m_levelOffsets.clear();
+    m_children.clear();
+}
+
+int ClusterTree::getNodeIndex(const int depth, const int id) const
+{
+    if (m_nodes.empty() || depth < MIN_CLUSTER_DEPTH || depth > MAX_CLUSTER_DEPTH || id < 0)
+    {
+        return -1;
+    }
+    const std::uint32_t node {m_levelOffsets[depth - MIN_CLUSTER_DEPTH] + static_cast<std::uint32_t>(id)};
+    return node < m_levelOffsets[depth - MIN_CLUSTER_DEPTH + 1] ? static_cast<int>(node) : -1;
+}
+
+const ClusterNode* ClusterTree::getNode(const int depth, const int id) const
+{
+    const int node {getNodeIndex(depth, id)};
+    return node >= 0 ? &m_nodes[node] : nullptr;
+}
+
+std::span<const ClusterNode> ClusterTree::getLevel(const int depth) const
+{
+    if (m_nodes.empty() || depth < MIN_CLUSTER_DEPTH || depth > MAX_CLUSTER_DEPTH)
+    {
+        return {};
+    }
+    const std::uint32_t first {m_levelOffsets[depth - MIN_CLUSTER_DEPTH]};
+    return std::span<const ClusterNode>{m_nodes}.subspan(first, m_levelOffsets[depth - MIN_CLUSTER_DEPTH + 1] - first);
+}
+
+std::span<const std::uint32_t> ClusterTree::getChildren(const int node) const
+{
+    return std::span<const std::uint32_t>{m_children}.subspan(m_nodes[node].firstChild, m_nodes[node].numChildren);
+}
+
+int ClusterTree::getAncestor(int node, const int ancestorDepth) const
+{
+    while (node >= 0 && m_nodes[node].depth > ancestorDepth)
+    {
+        node = m_nodes[node].parent;
+    }
+    return node >= 0 && m_nodes[node].depth == ancestorDepth ? node : -1;
+}
+
+void ClusterTree::rollUp(const std::span<const int> values, const int depth, const int parentDepth, std::vector<int>& parentValues) const
+{
+    parentValues.assign(getLevel(parentDepth).size(), 0);
+    for (std::size_t id{0}; id < values.size(); ++id)
+    {
+        const int ancestor {getAncestor(getNodeIndex(depth, static_cast<int>(id)), parentDepth)};
+        if (ancestor >= 0)
+        {
+            parentValues[m_nodes[ancestor].id] += values[id];
+        }
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Hierarchy of the precomputed cluster levels (depths 2-6), built once the papers are loaded.
+ * Every cluster is a node with its parent at the next coarser depth, its children at the next finer depth &
+ * stats aggregated over its papers, so drill-down, roll-up & multi-level charts don't scan the papers again.
+ */
+
+#ifndef CLUSTER_TREE_H
+#define CLUSTER_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "paper_table.h"
+
+struct ClusterMembers;
+
+struct ClusterNode
+{
+    int depth{0};
+    int id{0};
+    // node of the coarser cluster most of the papers are in, -1 at the coarsest depth (or without papers)
+    int parent{-1};
+    // children are m_children[firstChild, firstChild + numChildren)
+    std::uint32_t firstChild{0};
+    std::uint32_t numChildren{0};
+
+    int numPapers{0};
+    int numIncluded{0};
+    // papers that are also in the parent (numPapers if the levels nest)
+    int numInParent{0};
+    // bounding box of the papers
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+};
+
+class ClusterTree
+{
+public:
+    // build nodes from the cluster ids & members of each depth (members[depth - MIN_CLUSTER_DEPTH]),
+    // levels are built in parallel for large tables
+    void build(const PaperTable& papers, std::span<const ClusterMembers> members);
+    void clear();
+
+    [[nodiscard]] bool empty() const {return m_nodes.empty();}
+    [[nodiscard]] std::size_t size() const {return m_nodes.size();}
+
+    // node index of cluster id at depth (2-6), -1 if there's no such cluster
+    [[nodiscard]] int getNodeIndex(int depth, int id) const;
+    [[nodiscard]] const ClusterNode& getNode(const int node) const {return m_nodes[node];}
+    [[nodiscard]] const ClusterNode* getNode(int depth, int id) const;
+    // nodes of depth (2-6), indexed by cluster id
+    [[nodiscard]] std::span<const ClusterNode> getLevel(int depth) const;
+    // node indices of the children (ascending cluster id)
+    [[nodiscard]] std::span<const std::uint32_t> getChildren(int node) const;
+    // node of the cluster at ancestorDepth (<= the node's depth) that node rolls up into, -1 if there's none
+    [[nodiscard]] int getAncestor(int node, int ancestorDepth) const;
+
+    // sum per-cluster values of depth (indexed by cluster id) into the clusters at the coarser parentDepth,
+    // e.g. to roll up explored counts for a coarser bar chart
+    void rollUp(std::span<const int> values, int depth, int parentDepth, std::vector<int>& parentValues) const;
+
+private:
+    // stats & parent of the nodes of depth, from the papers of each cluster
+    void buildLevel(const PaperTable& papers, std::span<const ClusterMembers> members, int depth);
+
+    std::vector<ClusterNode> m_nodes{};
+    // first node of each depth (& the end)
+    std::vector<std::uint32_t> m_levelOffsets{};
+    std::vector<std::uint32_t> m_children{};
+};
+
+#endif
@@ -1,19 +1,38 @@
 #include "clusters.h"
 
-// convex hull library
-#define CONVHULL_3D_ENABLE
-#include <convhull_3d.h>
-
+#include "hull_builder.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <iomanip>
 #include <iostream>
 #include <utility>
 #include <glm/ext/matrix_transform.hpp>
 
-#include <assimp/postprocess.h>
-#include <assimp/Importer.hpp>
+namespace
+{
+    // flat shaded face (its own 3 vertices with the face normal), corners counter-clockwise seen from outside
+    void appendFace(const glm::dvec3 (&corners)[3], std::vector<Clusters::Vertex>& vertices, std::vector<unsigned int>& indices)
+    {
+        const glm::dvec3 normal {glm::cross(corners[1] - corners[0], corners[2] - corners[0])};
+        const double length {glm::length(normal)};
+        const glm::vec3 faceNormal {length > 0.0 ? glm::vec3{normal / length} : glm::vec3{0.0f}};
+        for (const glm::dvec3& corner : corners)
+        {
+            indices.push_back(static_cast<unsigned int>(vertices.size()));
+            vertices.push_back({glm::vec3{corner}, faceNormal});
+        }
+    }
+}
 
 Clusters::ClusterRenderer::ClusterRenderer()
 {
-    m_clusters.resize(5);
+    // precomputed levels & the k-means level
+    m_clusters.resize(KMEANS_CLUSTER_DEPTH - MIN_CLUSTER_DEPTH + 1);
 }
 
 Clusters::ClusterRenderer::~ClusterRenderer()
@@ -21,82 +40,263 @@ Clusters::ClusterRenderer::~ClusterRenderer()
     free();
 }
 
-// load convex hull for each cluster
-int Clusters::ClusterRenderer::generateClusters(const std::vector<std::map<int, Cluster>> &clusters)
+void Clusters::ClusterRenderer::buildHull(const std::span<const glm::vec3> positions, const std::span<const std::uint32_t> members, ConvexHull& hull)
 {
-    m_loaded = false;
-    // iterate over each cluster depth
-    for (std::size_t i{0}; i < clusters.size(); ++i)
+    const auto start {std::chrono::steady_clock::now()};
+    hull.numPapers = static_cast<int>(members.size());
+    hull.vertices.clear();
+    hull.indices.clear();
+
+    // corners of the faces, counter-clockwise seen from outside
+    std::vector<glm::dvec3> corners;
+    hull.numCandidates = HullBuilder::build(positions, members, true, corners);
+    // flat shading, so every face gets its own vertices with the face normal
+    hull.vertices.reserve(corners.size());
+    hull.indices.reserve(corners.size());
+    for (std::size_t c{0}; c + 2 < corners.size(); c += 3)
     {
-        // go through each cluster
-        for (const auto&[idx, cluster] : clusters[i])
-        {
-            // cluster rendering data
-            ConvexHull* hull {new ConvexHull};
+        const glm::dvec3 face[3] {corners[c], corners[c + 1], corners[c + 2]};
+        appendFace(face, hull.vertices, hull.indices);
+    }
+    hull.buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 
-            // allocate memory for papers
-            auto* chVertices = new ch_vertex[cluster.num_papers];
-            hull->numVertices = cluster.num_papers;
+// build convex hull for each cluster
+int Clusters::ClusterRenderer::generateClusters(const PaperLoader& paperLoader, std::vector<ConvexHull>& hulls)
+{
+    // one hull per cluster of each depth
+    hulls.clear();
+    for (int depth{MIN_CLUSTER_DEPTH}; depth <= MAX_CLUSTER_DEPTH; ++depth)
+    {
+        addClusterHulls(paperLoader, depth, hulls);
+    }
+    return buildHulls(paperLoader, hulls);
+}
 
-            // get vertices from cluster
-            for (std::size_t v{0}; v < cluster.num_papers; ++v)
-            {
-                chVertices[v].x = cluster.vertices[v].x;
-                chVertices[v].y = cluster.vertices[v].y;
-                chVertices[v].z = cluster.vertices[v].z;
-            }
+int Clusters::ClusterRenderer::generateClusterLevel(const PaperLoader& paperLoader, const int depth, std::vector<ConvexHull>& hulls)
+{
+    hulls.clear();
+    addClusterHulls(paperLoader, depth, hulls);
+    return buildHulls(paperLoader, hulls);
+}
 
-            // build convex hull
-            convhull_3d_build(chVertices, hull->numVertices, &hull->faceIndices, &hull->numFaces);
-            // export for testing
-            std::stringstream filename;
-            filename << "../data/cluster_models/cluster_" << i + 2 << "_" << idx;
-            std::string name {filename.str()};
-            convhull_3d_export_obj(chVertices, hull->numVertices, hull->faceIndices, hull->numFaces, 1, const_cast<char*>(name.c_str()));
-            // success check
-            if (hull->faceIndices == nullptr)
-            {
-                std::cout << "ERROR::CLUSTER_RENDERER::GENERATE_CLUSTERS: Failed to create convex hull!" << std::endl;
-                return -1;
-            }
+void Clusters::ClusterRenderer::addClusterHulls(const PaperLoader& paperLoader, const int depth, std::vector<ConvexHull>& hulls)
+{
+    const std::size_t numClusters {paperLoader.getClusters(depth).size()};
+    for (std::size_t idx{0}; idx < numClusters; ++idx)
+    {
+        if (!paperLoader.getClusterMembers(depth, static_cast<int>(idx)).empty())
+        {
+            hulls.push_back({depth, static_cast<int>(idx)});
+        }
+    }
+}
 
-            // free memory
-            delete[] chVertices;
-            delete[] hull->faceIndices;
-            delete hull;
+int Clusters::ClusterRenderer::buildHulls(const PaperLoader& paperLoader, std::vector<ConvexHull>& hulls)
+{
+    const auto start {std::chrono::steady_clock::now()};
+    const std::span<const glm::vec3> positions {paperLoader.getPapers().getPositions3D()};
+
+    // largest clusters first, so a big one doesn't start last & keep a single worker busy at the end
+    std::vector<ConvexHull*> order(hulls.size());
+    for (std::size_t h{0}; h < hulls.size(); ++h)
+    {
+        order[h] = &hulls[h];
+    }
+    std::ranges::stable_sort(order, [&paperLoader](const ConvexHull* a, const ConvexHull* b) {
+        return paperLoader.getClusterMembers(a->depth, a->idx).size() > paperLoader.getClusterMembers(b->depth, b->idx).size();
+    });
+    ThreadPool& pool {ThreadPool::shared()};
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(order.size());
+    for (ConvexHull* hull : order)
+    {
+        tasks.push_back(pool.submit([&paperLoader, positions, hull] {
+            buildHull(positions, paperLoader.getClusterMembers(hull->depth, hull->idx), *hull);
+        }));
+    }
+    for (std::future<void>& task : tasks)
+    {
+        task.get();
+    }
+    const double totalTime {std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+
+    // report in cluster order
+    const std::ios::fmtflags flags {std::cout.flags()};
+    const std::streamsize precision {std::cout.precision()};
+    std::cout << std::fixed << std::setprecision(2);
+    double buildTime{0.0};
+    bool failed{false};
+    for (const ConvexHull& hull : hulls)
+    {
+        buildTime += hull.buildTime;
+        std::cout << "\tCluster " << hull.depth << "_" << hull.idx << ": " << hull.numPapers << " papers (" << hull.numCandidates << " hull candidates), "
+                  << hull.indices.size() / 3 << " faces (" << hull.buildTime * 1000.0 << " ms)\n";
+        // success check
+        if (hull.indices.empty())
+        {
+            std::cout << "ERROR::CLUSTER_RENDERER::GENERATE_CLUSTERS: Failed to create convex hull!" << std::endl;
+            failed = true;
         }
-        std::cout << "Generated cluster level " << i + 2 << std::endl;
     }
+    std::cout << "Generated " << hulls.size() << " convex hulls in " << totalTime * 1000.0 << " ms (" << buildTime * 1000.0
+              << " ms of hull building on " << pool.size() << " threads)" << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+    return failed ? -1 : 0;
+}
 
-    // all good
-    std::cout << "Clusters generated!" << std::endl;
-    m_loaded = true;
-    return 0;
+namespace
+{
+    // hull cache (.pvhulls), shares the paper cache's header so it's rebuilt when the papers or the scale change
+    constexpr char HULL_CACHE_MAGIC[8] {'P', 'V', 'H', 'U', 'L', 'L', 'S', '\0'};
+    // bump whenever the layout changes
+    constexpr std::uint32_t HULL_CACHE_VERSION {1};
+
+    // hull as stored in the cache, vertices & indices are ranges of the shared arrays
+    struct CachedHull
+    {
+        std::int32_t depth;
+        std::int32_t idx;
+        std::int32_t numPapers;
+        std::uint32_t firstVertex;
+        std::uint32_t numVertices;
+        std::uint32_t firstIndex;
+        std::uint32_t numIndices;
+    };
 }
 
-void Clusters::ClusterRenderer::loadClusters(const std::vector<std::map<int, Cluster>>& clusters)
+std::string Clusters::ClusterRenderer::getHullCachePath(const std::string& filename)
 {
-    for (std::size_t i{0}; i < clusters.size(); ++i)
+    return filename + ".pvhulls";
+}
+
+bool Clusters::ClusterRenderer::saveHulls(const std::string& path, const PaperCache::SourceInfo& source, const std::vector<ConvexHull>& hulls)
+{
+    std::vector<CachedHull> cached;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    for (const ConvexHull& hull : hulls)
+    {
+        cached.push_back({hull.depth, hull.idx, hull.numPapers, static_cast<std::uint32_t>(vertices.size()), static_cast<std::uint32_t>(hull.vertices.size()),
+                          static_cast<std::uint32_t>(indices.size()), static_cast<std::uint32_t>(hull.indices.size())});
+        vertices.insert(vertices.end(), hull.vertices.begin(), hull.vertices.end());
+        indices.insert(indices.end(), hull.indices.begin(), hull.indices.end());
+    }
+    PaperCache::Writer writer{path};
+    writer.write(PaperCache::makeHeader(source, HULL_CACHE_MAGIC, HULL_CACHE_VERSION));
+    writer.writeArray(std::span<const CachedHull>{cached});
+    writer.writeArray(std::span<const Vertex>{vertices});
+    writer.writeArray(std::span<const unsigned int>{indices});
+    return writer.finish();
+}
+
+bool Clusters::ClusterRenderer::loadHulls(const std::string& path, const PaperLoader& paperLoader, std::vector<ConvexHull>& hulls)
+{
+    const MappedFile file{path};
+    if (!file.isOpen())
+    {
+        return false;
+    }
+    PaperCache::Reader reader{file.view()};
+    PaperCache::Header header;
+    std::span<const CachedHull> cached;
+    std::span<const Vertex> vertices;
+    std::span<const unsigned int> indices;
+    if (!reader.read(header) || !PaperCache::isValid(header, paperLoader.getSourceInfo(), HULL_CACHE_MAGIC, HULL_CACHE_VERSION)
+        || !reader.readArray(cached) || !reader.readArray(vertices) || !reader.readArray(indices))
     {
-        for (const auto&[idx, cluster] : clusters[i])
+        return false;
+    }
+
+    hulls.clear();
+    for (const CachedHull& hull : cached)
+    {
+        // every hull has to belong to a cluster with the same papers & stay inside the arrays
+        const bool valid {hull.depth >= MIN_CLUSTER_DEPTH && hull.depth <= MAX_CLUSTER_DEPTH
+                          && static_cast<std::size_t>(hull.numPapers) == paperLoader.getClusterMembers(hull.depth, hull.idx).size()
+                          && hull.firstVertex <= vertices.size() && hull.numVertices <= vertices.size() - hull.firstVertex
+                          && hull.firstIndex <= indices.size() && hull.numIndices <= indices.size() - hull.firstIndex
+                          && std::ranges::all_of(indices.subspan(hull.firstIndex, hull.numIndices), [&hull](const unsigned int index) { return index < hull.numVertices; })};
+        if (!valid)
         {
-            ClusterData clusterData{};
+            hulls.clear();
+            return false;
+        }
+        const std::span<const Vertex> hullVertices {vertices.subspan(hull.firstVertex, hull.numVertices)};
+        const std::span<const unsigned int> hullIndices {indices.subspan(hull.firstIndex, hull.numIndices)};
+        hulls.push_back({hull.depth, hull.idx, hull.numPapers, 0, {hullVertices.begin(), hullVertices.end()}, {hullIndices.begin(), hullIndices.end()}});
+    }
+    return true;
+}
 
-            // load convex hull model
-            std::stringstream filename;
-            filename << "../data/cluster_models/cluster_" << i + 2 << "_" << idx << ".obj";
-            const std::string name {filename.str()};
-            ClusterModel* model {new ClusterModel{name}};
-            clusterData.model = model;
+void Clusters::ClusterRenderer::loadClusters(const PaperLoader& paperLoader, const std::string& filename)
+{
+    // hulls from the cache, or build them again if it's stale
+    const auto start {std::chrono::steady_clock::now()};
+    const std::string cachePath {getHullCachePath(filename)};
+    std::vector<ConvexHull> hulls;
+    if (loadHulls(cachePath, paperLoader, hulls))
+    {
+        std::cout << "Loaded " << hulls.size() << " convex hulls from `" << cachePath << "`\n";
+    } else
+    {
+        std::cout << "Hull cache `" << cachePath << "` is missing or stale, generating convex hulls...\n";
+        if (generateClusters(paperLoader, hulls) == 0 && !saveHulls(cachePath, paperLoader.getSourceInfo(), hulls))
+        {
+            std::cerr << "Error: Failed to write cache to path: `" << cachePath << "`" << std::endl;
+        }
+    }
 
-            // get cluster centroid
-            clusterData.position = cluster.pos;
-            m_clusters[i].insert(std::pair<int, ClusterData>{idx, clusterData});
+    uploadHulls(paperLoader, hulls);
+    m_loaded = true;
+    const std::chrono::duration<double, std::milli> time {std::chrono::steady_clock::now() - start};
+    std::cout << "Loaded " << hulls.size() << " cluster models (" << time.count() << " ms)" << std::endl;
+}
 
-            std::cout << "\tLoaded cluster model from `" << name << "`\n";
+void Clusters::ClusterRenderer::loadClusterLevel(const PaperLoader& paperLoader, const int depth)
+{
+    // not cached, the clusters of the level change every time (k-means)
+    std::vector<ConvexHull> hulls;
+    generateClusterLevel(paperLoader, depth, hulls);
+    for (std::pair<const int, ClusterData>& clusterPair : m_clusters[depth - 2])
+    {
+        if (clusterPair.second.model != nullptr)
+        {
+            clusterPair.second.model->free();
+            delete clusterPair.second.model;
         }
+    }
+    m_clusters[depth - 2].clear();
+    uploadHulls(paperLoader, hulls);
+    // explored hulls of the old clusters
+    if (m_exploredDepth == depth)
+    {
+        freeExplored();
+        m_explored.clear();
+    }
+}
 
-        std::cout << "Loaded cluster level " << i + 2 << std::endl;
+void Clusters::ClusterRenderer::uploadHulls(const PaperLoader& paperLoader, const std::vector<ConvexHull>& hulls)
+{
+    for (const ConvexHull& hull : hulls)
+    {
+        if (hull.indices.empty())
+        {
+            continue;
+        }
+        ClusterData clusterData{};
+        clusterData.model = new ClusterModel{hull.vertices, hull.indices};
+        // get cluster centroid
+        clusterData.position = paperLoader.getClusters(hull.depth)[hull.idx].pos;
+        // assigned, since getClusterData() may have added an empty entry while papers were streaming in
+        ClusterData& current {m_clusters[hull.depth - 2][hull.idx]};
+        if (current.model != nullptr)
+        {
+            current.model->free();
+            delete current.model;
+        }
+        current = clusterData;
     }
 }
 
@@ -116,6 +316,21 @@ void Clusters::ClusterRenderer::free()
             cluster.model = nullptr;
         }
     }
+    freeExplored();
+}
+
+void Clusters::ClusterRenderer::freeExplored()
+{
+    for (ExploredCluster& explored : m_explored)
+    {
+        if (explored.model != nullptr)
+        {
+            explored.model->free();
+            delete explored.model;
+        }
+        explored.model = nullptr;
+        explored.started = false;
+    }
 }
 
 
@@ -125,16 +340,106 @@ Clusters::ClusterData* Clusters::ClusterRenderer::getClusterData(const int depth
     return &m_clusters[depth - 2][idx];
 }
 
+void Clusters::ClusterRenderer::updateExploredClusters(const PaperLoader& paperLoader, const int depth, const std::size_t numExplored,
+                                                       const bool rewinding)
+{
+    const std::size_t numClusters {paperLoader.getClusters(depth).size()};
+    if (depth != m_exploredDepth || m_explored.size() != numClusters)
+    {
+        freeExplored();
+        m_explored.resize(numClusters);
+        m_exploredDepth = depth;
+    }
+
+    const std::span<const glm::vec3> positions {paperLoader.getPapers().getPositions3D()};
+    for (std::size_t idx{0}; idx < m_explored.size(); ++idx)
+    {
+        ExploredCluster& explored {m_explored[idx]};
+        // members are sorted, so the explored ones come first
+        const std::span<const std::uint32_t> members {paperLoader.getClusterMembers(depth, static_cast<int>(idx))};
+        const std::size_t numMembers {static_cast<std::size_t>(std::ranges::lower_bound(members, numExplored) - members.begin())};
+        bool changed{false};
+        // papers can't be removed from the hull, so it's built again (once the animation stops going back, a rebuild
+        // per frame would be too slow), clusters without explored papers lose their hull straight away
+        if (explored.started && numMembers < explored.hull.getNumInserted())
+        {
+            if (rewinding && numMembers > 0)
+            {
+                continue;
+            }
+            explored.started = false;
+            changed = true;
+        }
+        if (!explored.started && numMembers > 0)
+        {
+            explored.hull.reset(positions, members);
+            explored.started = true;
+        }
+        if (explored.started)
+        {
+            changed |= explored.hull.insertUpTo(numMembers);
+        }
+        if (!changed)
+        {
+            continue;
+        }
+
+        // upload the new faces
+        m_exploredVertices.clear();
+        m_exploredIndices.clear();
+        if (explored.started)
+        {
+            explored.hull.getTriangles(m_exploredCorners);
+        } else
+        {
+            m_exploredCorners.clear();
+        }
+        for (std::size_t c{0}; c < m_exploredCorners.size(); c += 3)
+        {
+            const glm::dvec3 corners[3] {m_exploredCorners[c], m_exploredCorners[c + 1], m_exploredCorners[c + 2]};
+            appendFace(corners, m_exploredVertices, m_exploredIndices);
+        }
+        if (m_exploredIndices.empty())
+        {
+            if (explored.model != nullptr)
+            {
+                explored.model->free();
+                delete explored.model;
+            }
+            explored.model = nullptr;
+        } else if (explored.model != nullptr)
+        {
+            explored.model->update(m_exploredVertices, m_exploredIndices);
+        } else
+        {
+            explored.model = new ClusterModel{m_exploredVertices, m_exploredIndices};
+        }
+    }
+}
+
+void Clusters::ClusterRenderer::renderExploredCluster(const Shader& shader, const glm::mat4& projection, const glm::mat4& view,
+                                                      const glm::vec3& color, const int depth, const int idx)
+{
+    if (depth == m_exploredDepth && idx >= 0 && static_cast<std::size_t>(idx) < m_explored.size())
+    {
+        renderModel(shader, projection, view, color, m_explored[idx].model);
+    }
+}
+
 void Clusters::ClusterRenderer::renderCluster(const Shader &shader, const glm::mat4 &projection, const glm::mat4 &view,
                                               const glm::vec3 &color, const int depth, const int idx)
+{
+    renderModel(shader, projection, view, color, getClusterData(depth, idx)->model);
+}
+
+void Clusters::ClusterRenderer::renderModel(const Shader& shader, const glm::mat4& projection, const glm::mat4& view,
+                                            const glm::vec3& color, ClusterModel* const clusterModel)
 {
     shader.use();
     // set camera uniforms
     shader.setMat4("projection", projection);
     shader.setMat4("view", view);
 
-    const ClusterData* cluster {getClusterData(depth, idx)};
-
     glm::mat4 model{1.0f};
     // model = glm::translate(model, cluster->position);
     // model = glm::scale(model, glm::vec3{1.7f});
@@ -143,9 +448,9 @@ void Clusters::ClusterRenderer::renderCluster(const Shader &shader, const glm::m
     // color uniform
     shader.setVec3("color", color);
 
-    if (cluster->model != nullptr)
+    if (clusterModel != nullptr)
     {
-        cluster->model->render(shader);
+        clusterModel->render(shader);
     }
 }
 
@@ -202,6 +507,20 @@ void Clusters::ClusterMesh::setupMesh()
     glBindVertexArray(0);
 }
 
+void Clusters::ClusterMesh::update(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    m_vertices = vertices;
+    m_indices = indices;
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_vertices.size() * sizeof(Vertex)), m_vertices.data(),
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(m_indices.size() * sizeof(unsigned int)),
+                 m_indices.data(), GL_DYNAMIC_DRAW);
+    glBindVertexArray(0);
+}
+
 void Clusters::ClusterMesh::free() const
 {
     glDeleteBuffers(1, &VBO);
@@ -219,12 +538,9 @@ void Clusters::ClusterMesh::render(const Shader& shader) const
 }
 
 // Convex Hull model
-// use assimp to load model meshes from path
-Clusters::ClusterModel::ClusterModel(const std::string& path)
-    : m_path{path}
+Clusters::ClusterModel::ClusterModel(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
 {
-    std::cout << "Created cluster model at path: `" << path <<"`\n";
-    loadModel(path);
+    m_meshes.emplace_back(vertices, indices);
 }
 
 void Clusters::ClusterModel::free()
@@ -235,6 +551,11 @@ void Clusters::ClusterModel::free()
     }
 }
 
+void Clusters::ClusterModel::update(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    m_meshes.front().update(vertices, indices);
+}
+
 
 // render all the model meshes
 void Clusters::ClusterModel::render(const Shader& shader)
@@ -244,66 +565,3 @@ void Clusters::ClusterModel::render(const Shader& shader)
         mesh.render(shader);
     }
 }
-
-// load meshes from path
-void Clusters::ClusterModel::loadModel(const std::string& path)
-{
-    std::cout << "Loading cluster model from path: `" << path << "`... ";
-    Assimp::Importer importer;
-    const aiScene* scene {importer.ReadFile(path.c_str(), aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace)};
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
-    {
-        std::cout << "ERROR::ASSIMP:" << importer.GetErrorString() << std::endl;
-        return;
-    }
-    m_directory = path.substr(0, path.find_last_of('/'));
-    processNode(scene->mRootNode, scene);
-    std::cout << "Loaded cluster model from path: `" << path << "`!\n";
-}
-
-// recursively load meshes from root node and children
-void Clusters::ClusterModel::processNode(aiNode* node, const aiScene* scene)
-{
-    for (std::size_t i {0}; i < node->mNumMeshes; ++i)
-    {
-        // get mesh from scene
-        aiMesh* mesh {scene->mMeshes[node->mMeshes[i]]};
-        m_meshes.push_back(processMesh(mesh));
-    }
-
-    // repeat for child nodes
-    for (std::size_t n {0}; n < node->mNumChildren; ++n)
-    {
-        processNode(node->mChildren[n], scene);
-    }
-}
-
-Clusters::ClusterMesh Clusters::ClusterModel::processMesh(const aiMesh* mesh)
-{
-    std::vector<Vertex> vertices{};
-    std::vector<unsigned int> indices{};
-
-    for (std::size_t v {0}; v < mesh->mNumVertices; ++v)
-    {
-        // process vertex
-        Vertex vertex {
-            glm::vec3 {mesh->mVertices[v].x, mesh->mVertices[v].y, mesh->mVertices[v].z},
-            glm::vec3 {mesh->mNormals[v].x, mesh->mNormals[v].y, mesh->mNormals[v].z},
-        };
-
-        vertices.push_back(vertex);
-    }
-
-    // same idea for indices
-    for (std::size_t i{0}; i < mesh->mNumFaces; ++i)
-    {
-        aiFace face {mesh->mFaces[i]};
-        // each face usually has like 3 indices or something
-        for (unsigned int j{0}; j < face.mNumIndices; ++j)
-        {
-            indices.push_back(face.mIndices[j]);
-        }
-    }
-
-    return ClusterMesh{vertices, indices};
-}
\ No newline at end of file
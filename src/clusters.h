@@ -5,10 +5,9 @@
 // opengl rendering
 #include <glad/glad.h>
 
-// for assimp model loading
-#include <assimp/scene.h>
-
 #include "paper_loader.h"
+#include "paper_cache.h"
+#include "incremental_hull.h"
 #include "opengl/shader.h"
 #include "opengl/fonts.h"
 
@@ -28,6 +27,8 @@ namespace Clusters
         ClusterMesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
 
         void free() const;
+        // replace the vertices & indices (the buffers are reallocated)
+        void update(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
 
         void render(const Shader& shader) const;
 
@@ -43,29 +44,30 @@ namespace Clusters
     class ClusterModel
     {
     public:
-        explicit ClusterModel(const std::string& path);
+        // upload mesh of a convex hull
+        ClusterModel(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
 
         void free();
+        void update(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
 
         void render(const Shader& shader);
 
     private:
-        std::string m_path;
         std::vector<ClusterMesh> m_meshes{};
-        std::string m_directory{};
-
-        void loadModel(const std::string& path);
-        void processNode(aiNode* node, const aiScene* scene);
-
-        static ClusterMesh processMesh(const aiMesh* mesh);
     };
 
-    // used to generate convex hull (and export to wavefront)
+    // convex hull of a cluster's papers, as a flat shaded mesh (3 vertices with the face normal per face)
     struct ConvexHull
     {
-        int numVertices{};
-        int* faceIndices{nullptr};
-        int numFaces{};
+        int depth{};
+        int idx{};
+        int numPapers{};
+        // papers left after prefiltering, that the hull was built from
+        int numCandidates{};
+        std::vector<Vertex> vertices{};
+        std::vector<unsigned int> indices{};
+        // time to build the hull in seconds
+        double buildTime{};
     };
 
     struct ClusterData
@@ -81,19 +83,41 @@ namespace Clusters
         ClusterRenderer();
         ~ClusterRenderer();
 
-        // generates convex hulls for clusters and saves to wavefront .obj in data/cluster_models
-        int generateClusters(const std::vector<std::map<int, Cluster>> &clusters);
-
-        // load convex hulls for clusters from wavefront .obj files in data/cluster_models (models generated by ClusterRenderer::generateClusters)
-        void loadClusters(const std::vector<std::map<int, Cluster>>& clusters);
+        // generates convex hulls for clusters (from the positions of their member papers), returns -1 if any failed
+        // (one task per cluster on the shared thread pool, largest clusters first)
+        static int generateClusters(const PaperLoader& paperLoader, std::vector<ConvexHull>& hulls);
+        // same for the clusters of a single depth (e.g. the k-means clusters)
+        static int generateClusterLevel(const PaperLoader& paperLoader, int depth, std::vector<ConvexHull>& hulls);
+        // build convex hull of the papers in members, hull.indices is empty if it failed
+        static void buildHull(std::span<const glm::vec3> positions, std::span<const std::uint32_t> members, ConvexHull& hull);
+
+        // hull cache lives next to the papers file
+        [[nodiscard]] static std::string getHullCachePath(const std::string& filename);
+        // write hulls to the hull cache (keyed by the papers' source file & scale)
+        static bool saveHulls(const std::string& path, const PaperCache::SourceInfo& source, const std::vector<ConvexHull>& hulls);
+        // read hulls from the hull cache, returns false if it's missing, stale or doesn't match the clusters
+        static bool loadHulls(const std::string& path, const PaperLoader& paperLoader, std::vector<ConvexHull>& hulls);
+
+        // upload convex hulls of the clusters, from the hull cache next to filename (or generated & cached if it's stale)
+        void loadClusters(const PaperLoader& paperLoader, const std::string& filename);
+        // generate & upload the convex hulls of the clusters at depth again, replacing the old ones (not cached)
+        void loadClusterLevel(const PaperLoader& paperLoader, int depth);
         // not const because std::map[] isn't const
         ClusterData* getClusterData(int depth, int idx);
 
+        // grow the explored hulls of the clusters at depth to the papers before numExplored (papers are explored in
+        // index order), only the clusters that changed are uploaded again. Going back rebuilds the clusters that lost papers,
+        // unless rewinding (the animation is still running backwards), then they keep their hull until it stops
+        void updateExploredClusters(const PaperLoader& paperLoader, int depth, std::size_t numExplored, bool rewinding);
+
         void free();
 
         // same here
         void renderCluster(const Shader &shader, const glm::mat4 &projection, const glm::mat4 &view,
                            const glm::vec3 &color, int depth, int idx);
+        // explored hull of a cluster (nothing if updateExploredClusters() wasn't called for depth)
+        void renderExploredCluster(const Shader& shader, const glm::mat4& projection, const glm::mat4& view,
+                                   const glm::vec3& color, int depth, int idx);
         void renderClusterText(const Shader &shader, const glm::mat4 &projection, const glm::mat4 &view,
                                const glm::vec3 &color, int depth, int idx, FontManager &fontManager,
                                const Shader &fontShader, const std::string& clusterLabel,
@@ -101,10 +125,34 @@ namespace Clusters
         // void renderClusterLevel(const Shader& shader, const glm::mat4& projection, const glm::mat4& view, const glm::vec3& color, int depth);
 
     private:
+        // hull of the papers of a cluster the animation has passed
+        struct ExploredCluster
+        {
+            IncrementalHull hull{};
+            ClusterModel* model{nullptr};
+            bool started{false};
+        };
+
+        // add an empty hull for each cluster with papers at depth
+        static void addClusterHulls(const PaperLoader& paperLoader, int depth, std::vector<ConvexHull>& hulls);
+        // build hulls (in parallel), report them & return -1 if any failed
+        static int buildHulls(const PaperLoader& paperLoader, std::vector<ConvexHull>& hulls);
+        void uploadHulls(const PaperLoader& paperLoader, const std::vector<ConvexHull>& hulls);
+        static void renderModel(const Shader& shader, const glm::mat4& projection, const glm::mat4& view,
+                                const glm::vec3& color, ClusterModel* model);
+        void freeExplored();
+
         // flag to know if we need to free or not
         bool m_loaded{false};
         // contains cluster data for rendering
         std::vector<std::map<int, ClusterData>> m_clusters{};
+        // explored hulls of the clusters at m_exploredDepth, indexed by cluster id
+        std::vector<ExploredCluster> m_explored{};
+        int m_exploredDepth{0};
+        // scratch space to build the explored meshes in
+        std::vector<glm::dvec3> m_exploredCorners{};
+        std::vector<Vertex> m_exploredVertices{};
+        std::vector<unsigned int> m_exploredIndices{};
     };
 
 };
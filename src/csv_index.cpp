@@ -0,0 +1,177 @@
+#include "csv_index.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// SSE2 is always available on x86-64, AVX2 is picked at runtime
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define CSV_INDEX_X86
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // per-character loop, like PaperLoader used before the scanner (no masks to build without SIMD)
+    const char* scanScalar(const char* it, const char* const end, bool& quote, std::vector<const char*>& structurals)
+    {
+        for (; it < end; ++it)
+        {
+            const char c {*it};
+            if (c == '"')
+            {
+                quote = !quote;
+            } else if (!quote && (c == ',' || c == '\n'))
+            {
+                structurals.push_back(it);
+            }
+        }
+        return it;
+    }
+
+#ifdef CSV_INDEX_X86
+    // one bit per byte of a 64 byte block
+    struct BlockMasks
+    {
+        std::uint64_t quote;
+        std::uint64_t comma;
+        std::uint64_t newline;
+    };
+
+    std::uint64_t maskSSE2(const __m128i chunks[4], const char c)
+    {
+        const __m128i needle {_mm_set1_epi8(c)};
+        const auto m0 {static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[0], needle)))};
+        const auto m1 {static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[1], needle)))};
+        const auto m2 {static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[2], needle)))};
+        const auto m3 {static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[3], needle)))};
+        return std::uint64_t{m0} | std::uint64_t{m1} << 16 | std::uint64_t{m2} << 32 | std::uint64_t{m3} << 48;
+    }
+
+    BlockMasks masksSSE2(const char* data)
+    {
+        const __m128i chunks[4] {
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)),
+        };
+        return {maskSSE2(chunks, '"'), maskSSE2(chunks, ','), maskSSE2(chunks, '\n')};
+    }
+
+    __attribute__((target("avx2")))
+    std::uint64_t maskAVX2(const __m256i lo, const __m256i hi, const char c)
+    {
+        const __m256i needle {_mm256_set1_epi8(c)};
+        const auto l {static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, needle)))};
+        const auto h {static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, needle)))};
+        return std::uint64_t{l} | std::uint64_t{h} << 32;
+    }
+
+    __attribute__((target("avx2")))
+    BlockMasks masksAVX2(const char* data)
+    {
+        const __m256i lo {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data))};
+        const __m256i hi {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32))};
+        return {maskAVX2(lo, hi, '"'), maskAVX2(lo, hi, ','), maskAVX2(lo, hi, '\n')};
+    }
+
+    using MaskFunction = BlockMasks (*)(const char*);
+
+    MaskFunction getMaskFunction(const CsvIndex::Backend backend)
+    {
+        return backend == CsvIndex::Backend::AVX2 ? masksAVX2 : masksSSE2;
+    }
+
+    // bit i is set if an odd number of quote bits are set at or before i
+    std::uint64_t prefixXor(std::uint64_t x)
+    {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+#endif
+}
+
+CsvIndex::Backend CsvIndex::detectBackend()
+{
+#ifdef CSV_INDEX_X86
+    static const Backend backend {__builtin_cpu_supports("avx2") ? Backend::AVX2 : Backend::SSE2};
+    return backend;
+#else
+    return Backend::SCALAR;
+#endif
+}
+
+const char* CsvIndex::getBackendName(const Backend backend)
+{
+    switch (backend)
+    {
+        case Backend::AVX2:
+            return "AVX2";
+        case Backend::SSE2:
+            return "SSE2";
+        default:
+            return "SCALAR";
+    }
+}
+
+CsvIndex::Scanner::Scanner(const char* begin, const char* end, const Backend backend)
+    : m_it{begin}, m_end{end}, m_backend{backend}
+{
+#ifndef CSV_INDEX_X86
+    m_backend = Backend::SCALAR;
+#endif
+}
+
+bool CsvIndex::Scanner::next(std::vector<const char*>& structurals)
+{
+    structurals.clear();
+    if (m_it >= m_end)
+    {
+        return false;
+    }
+    const std::size_t remaining {static_cast<std::size_t>(m_end - m_it)};
+    const char* const windowEnd {m_it + std::min(WINDOW_SIZE, remaining)};
+
+    if (m_backend == Backend::SCALAR)
+    {
+        bool quote {m_quoteCarry != 0};
+        m_it = scanScalar(m_it, windowEnd, quote, structurals);
+        m_quoteCarry = quote ? ~std::uint64_t{0} : 0;
+        return true;
+    }
+#ifdef CSV_INDEX_X86
+    const MaskFunction masks {getMaskFunction(m_backend)};
+    const auto flatten = [this, &structurals](const BlockMasks& block, const char* data) {
+        // mask out everything between an opening and closing quote
+        const std::uint64_t inside {prefixXor(block.quote) ^ m_quoteCarry};
+        m_quoteCarry = static_cast<std::uint64_t>(static_cast<std::int64_t>(inside) >> 63);
+        std::uint64_t bits {(block.comma | block.newline) & ~inside};
+        while (bits != 0)
+        {
+            structurals.push_back(data + std::countr_zero(bits));
+            bits &= bits - 1;
+        }
+    };
+
+    // full blocks
+    for (; m_it + 64 <= windowEnd; m_it += 64)
+    {
+        flatten(masks(m_it), m_it);
+    }
+    // last partial block is padded with zeros (never structural)
+    if (m_it < windowEnd)
+    {
+        char block[64]{};
+        std::memcpy(block, m_it, static_cast<std::size_t>(windowEnd - m_it));
+        flatten(masks(block), m_it);
+        m_it = windowEnd;
+    }
+#endif
+    return true;
+}
@@ -0,0 +1,51 @@
+/*
+ * Vectorized structural indexer for csv data (simdjson style).
+ * Finds the commas and newlines that are outside of quotes, 64 bytes at a time (or a byte at a time without SIMD).
+ */
+
+#ifndef CSV_INDEX_H
+#define CSV_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CsvIndex
+{
+    // instruction set used to build the character masks, SCALAR checks one character at a time
+    enum class Backend
+    {
+        SCALAR,
+        SSE2,
+        AVX2,
+    };
+
+    // best backend supported by this cpu
+    [[nodiscard]] Backend detectBackend();
+    [[nodiscard]] const char* getBackendName(Backend backend);
+
+    // number of bytes indexed per call to Scanner::next()
+    constexpr std::size_t WINDOW_SIZE {64 * 1024};
+
+    // walks [begin, end) window by window, returning pointers to structural characters
+    class Scanner
+    {
+    public:
+        Scanner(const char* begin, const char* end, Backend backend = detectBackend());
+
+        // replaces structurals with the structural characters (',' or '\n' outside quotes) of the next window,
+        // returns false once all data has been indexed
+        bool next(std::vector<const char*>& structurals);
+
+        [[nodiscard]] Backend getBackend() const {return m_backend;}
+
+    private:
+        const char* m_it;
+        const char* m_end;
+        Backend m_backend;
+        // all ones if the previous block (or window) ended inside a quote
+        std::uint64_t m_quoteCarry{0};
+    };
+}
+
+#endif
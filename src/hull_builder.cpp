@@ -0,0 +1,336 @@
+#include "hull_builder.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <unordered_set>
+
+namespace
+{
+    // scratch memory for one hull build task, freed blocks are reused & grown geometrically
+    // (convhull_3d reallocates its face arrays for every point it adds to the hull)
+    class HullArena
+    {
+    public:
+        void* allocate(const std::size_t size)
+        {
+            // reuse the smallest free block that fits
+            Block* best {nullptr};
+            for (Block& block : m_blocks)
+            {
+                if (!block.used && block.capacity >= size && (best == nullptr || block.capacity < best->capacity))
+                {
+                    best = &block;
+                }
+            }
+            if (best == nullptr)
+            {
+                const std::size_t capacity {std::bit_ceil(std::max<std::size_t>(size, 64))};
+                best = &m_blocks.emplace_back(Block{std::make_unique<std::byte[]>(HEADER_SIZE + capacity), capacity, false});
+            }
+            best->used = true;
+            const std::size_t index {static_cast<std::size_t>(best - m_blocks.data())};
+            std::memcpy(best->data.get(), &index, sizeof(index));
+            return best->data.get() + HEADER_SIZE;
+        }
+
+        void* reallocate(void* ptr, const std::size_t size)
+        {
+            if (ptr == nullptr)
+            {
+                return allocate(size);
+            }
+            const std::size_t index {getIndex(ptr)};
+            const std::size_t capacity {m_blocks[index].capacity};
+            if (capacity >= size)
+            {
+                return ptr;
+            }
+            void* const newPtr {allocate(std::bit_ceil(size))};
+            std::memcpy(newPtr, ptr, capacity);
+            m_blocks[index].used = false;
+            return newPtr;
+        }
+
+        void release(void* ptr)
+        {
+            if (ptr != nullptr)
+            {
+                m_blocks[getIndex(ptr)].used = false;
+            }
+        }
+
+    private:
+        // block index is stored in front of the data (keeps the data aligned like new[])
+        static constexpr std::size_t HEADER_SIZE {__STDCPP_DEFAULT_NEW_ALIGNMENT__};
+
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t capacity;
+            bool used;
+        };
+
+        static std::size_t getIndex(void* ptr)
+        {
+            std::size_t index;
+            std::memcpy(&index, static_cast<std::byte*>(ptr) - HEADER_SIZE, sizeof(index));
+            return index;
+        }
+
+        // blocks don't move (only the vector of handles does)
+        std::vector<Block> m_blocks{};
+    };
+
+    // convhull_3d allocation hooks, calls without an arena use the heap
+    void* hullMalloc(void* arena, const std::size_t size)
+    {
+        return arena != nullptr ? static_cast<HullArena*>(arena)->allocate(size) : std::malloc(size);
+    }
+
+    void* hullCalloc(void* arena, const std::size_t num, const std::size_t size)
+    {
+        if (arena == nullptr)
+        {
+            return std::calloc(num, size);
+        }
+        void* const ptr {static_cast<HullArena*>(arena)->allocate(num * size)};
+        std::memset(ptr, 0, num * size);
+        return ptr;
+    }
+
+    void* hullRealloc(void* arena, void* ptr, const std::size_t size)
+    {
+        return arena != nullptr ? static_cast<HullArena*>(arena)->reallocate(ptr, size) : std::realloc(ptr, size);
+    }
+
+    void hullFree(void* arena, void* ptr)
+    {
+        if (arena != nullptr)
+        {
+            static_cast<HullArena*>(arena)->release(ptr);
+        } else
+        {
+            std::free(ptr);
+        }
+    }
+}
+
+// convex hull library
+#define ch_stateful_malloc(allocator, size) hullMalloc(allocator, size)
+#define ch_stateful_calloc(allocator, num, size) hullCalloc(allocator, num, size)
+#define ch_stateful_realloc(allocator, ptr, size) hullRealloc(allocator, ptr, size)
+#define ch_stateful_free(allocator, ptr) hullFree(allocator, ptr)
+#define CONVHULL_3D_ENABLE
+#include <convhull_3d.h>
+
+namespace
+{
+    // hulls of smaller clusters are built from all their papers
+    constexpr std::size_t MIN_PREFILTER_POINTS {512};
+    // papers are tested against all the planes block by block, so a block stays in cache
+    constexpr std::size_t PREFILTER_BLOCK_SIZE {2048};
+    // papers closer than this (relative to the cluster size) to the polytope are kept, which covers float
+    // rounding of the plane tests & the noise convhull_3d adds to the points
+    constexpr float PREFILTER_MARGIN {1e-5f};
+    // side of the grid cells (relative to the cluster size) that papers are merged in before building the hull,
+    // 0 disables it (merging makes the hull approximate)
+    constexpr float HULL_GRID_CELL_SIZE {0.0f};
+
+    // extreme papers are taken along these directions & their opposites (axes, edge & corner diagonals of a cube)
+    constexpr float EXTREME_DIRECTIONS[13][3] {
+        {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
+        {1.0f, 1.0f, 0.0f}, {1.0f, -1.0f, 0.0f}, {1.0f, 0.0f, 1.0f}, {1.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 1.0f}, {0.0f, 1.0f, -1.0f},
+        {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, -1.0f}, {1.0f, -1.0f, 1.0f}, {1.0f, -1.0f, -1.0f},
+    };
+
+    // points with dot(normal, p) > offset are outside
+    struct Plane
+    {
+        float x, y, z, offset;
+    };
+
+    // largest side of the bounding box of the papers
+    float getExtent(const std::span<const glm::vec3> positions, const std::span<const std::uint32_t> members)
+    {
+        glm::vec3 min {positions[members[0]]};
+        glm::vec3 max {min};
+        for (const std::uint32_t member : members)
+        {
+            min = glm::min(min, positions[member]);
+            max = glm::max(max, positions[member]);
+        }
+        const glm::vec3 size {max - min};
+        return std::max({size.x, size.y, size.z});
+    }
+
+    // outward facing planes of the polytope spanned by the extreme papers, returns false if it's degenerate
+    bool getExtremePlanes(const std::vector<float>& xs, const std::vector<float>& ys, const std::vector<float>& zs, const float margin,
+                          std::vector<Plane>& planes, HullArena& arena)
+    {
+        // papers furthest along each direction (both ways)
+        std::size_t extremes[26] {};
+        float dots[26];
+        for (std::size_t k{0}; k < 13; ++k)
+        {
+            const float dot {EXTREME_DIRECTIONS[k][0] * xs[0] + EXTREME_DIRECTIONS[k][1] * ys[0] + EXTREME_DIRECTIONS[k][2] * zs[0]};
+            dots[k * 2] = dot;
+            dots[k * 2 + 1] = -dot;
+        }
+        for (std::size_t i{1}; i < xs.size(); ++i)
+        {
+            for (std::size_t k{0}; k < 13; ++k)
+            {
+                const float dot {EXTREME_DIRECTIONS[k][0] * xs[i] + EXTREME_DIRECTIONS[k][1] * ys[i] + EXTREME_DIRECTIONS[k][2] * zs[i]};
+                if (dot > dots[k * 2])
+                {
+                    dots[k * 2] = dot;
+                    extremes[k * 2] = i;
+                }
+                if (-dot > dots[k * 2 + 1])
+                {
+                    dots[k * 2 + 1] = -dot;
+                    extremes[k * 2 + 1] = i;
+                }
+            }
+        }
+        std::sort(std::begin(extremes), std::end(extremes));
+        const std::size_t numCorners {static_cast<std::size_t>(std::unique(std::begin(extremes), std::end(extremes)) - std::begin(extremes))};
+        if (numCorners < 4)
+        {
+            return false;
+        }
+
+        std::vector<ch_vertex> corners(numCorners);
+        glm::dvec3 center {0.0};
+        for (std::size_t c{0}; c < numCorners; ++c)
+        {
+            corners[c].x = xs[extremes[c]];
+            corners[c].y = ys[extremes[c]];
+            corners[c].z = zs[extremes[c]];
+            center += glm::dvec3{corners[c].x, corners[c].y, corners[c].z};
+        }
+        center /= static_cast<double>(numCorners);
+        int* faces {nullptr};
+        int numFaces{0};
+        convhull_3d_build_alloc(corners.data(), static_cast<int>(numCorners), &faces, &numFaces, &arena);
+        if (faces == nullptr)
+        {
+            return false;
+        }
+        planes.clear();
+        bool valid {true};
+        for (int f{0}; f < numFaces && valid; ++f)
+        {
+            const ch_vertex& a {corners[faces[f * 3]]};
+            const ch_vertex& b {corners[faces[f * 3 + 1]]};
+            const ch_vertex& c {corners[faces[f * 3 + 2]]};
+            const glm::dvec3 origin {a.x, a.y, a.z};
+            glm::dvec3 normal {glm::cross(glm::dvec3{b.x, b.y, b.z} - origin, glm::dvec3{c.x, c.y, c.z} - origin)};
+            const double length {glm::length(normal)};
+            // a missing plane would make the polytope bigger than the hull
+            valid = length > 0.0;
+            normal /= length;
+            double offset {glm::dot(normal, origin)};
+            // orientation from the center, rather than relying on the winding
+            if (glm::dot(normal, center) > offset)
+            {
+                normal = -normal;
+                offset = -offset;
+            }
+            planes.push_back({static_cast<float>(normal.x), static_cast<float>(normal.y), static_cast<float>(normal.z), static_cast<float>(offset) - margin});
+        }
+        hullFree(&arena, faces);
+        return valid;
+    }
+
+    // Akl-Toussaint heuristic: papers strictly inside the polytope spanned by the extreme papers can't be on the hull,
+    // so only the others are returned as hull candidates (all of them without prefilter, or if the polytope can't be built)
+    std::vector<ch_vertex> getHullCandidates(const std::span<const glm::vec3> positions, const std::span<const std::uint32_t> members, const bool prefilter,
+                                             HullArena& arena)
+    {
+        const std::size_t numPoints {members.size()};
+        std::vector<ch_vertex> points;
+        const float extent {numPoints > 0 ? getExtent(positions, members) : 0.0f};
+        // structure of arrays, so the plane tests vectorize
+        std::vector<float> xs(numPoints);
+        std::vector<float> ys(numPoints);
+        std::vector<float> zs(numPoints);
+        for (std::size_t i{0}; i < numPoints; ++i)
+        {
+            const glm::vec3& pos {positions[members[i]]};
+            xs[i] = pos.x;
+            ys[i] = pos.y;
+            zs[i] = pos.z;
+        }
+
+        std::vector<unsigned char> candidates(numPoints, 1);
+        std::vector<Plane> planes;
+        if (prefilter && numPoints >= MIN_PREFILTER_POINTS && getExtremePlanes(xs, ys, zs, PREFILTER_MARGIN * extent, planes, arena))
+        {
+            std::fill(candidates.begin(), candidates.end(), 0);
+            for (std::size_t block{0}; block < numPoints; block += PREFILTER_BLOCK_SIZE)
+            {
+                const std::size_t end {std::min(numPoints, block + PREFILTER_BLOCK_SIZE)};
+                for (const Plane& plane : planes)
+                {
+                    for (std::size_t i{block}; i < end; ++i)
+                    {
+                        candidates[i] |= static_cast<unsigned char>(plane.x * xs[i] + plane.y * ys[i] + plane.z * zs[i] > plane.offset);
+                    }
+                }
+            }
+        }
+
+        // keep the first paper of each grid cell
+        std::unordered_set<std::uint64_t> cells;
+        const float cellSize {HULL_GRID_CELL_SIZE * extent};
+        for (std::size_t i{0}; i < numPoints; ++i)
+        {
+            if (candidates[i] == 0)
+            {
+                continue;
+            }
+            if (cellSize > 0.0f)
+            {
+                const auto cell = [cellSize](const float value) {
+                    return static_cast<std::uint64_t>(static_cast<std::int64_t>(std::floor(value / cellSize)) & 0x1FFFFF);
+                };
+                if (!cells.insert(cell(xs[i]) | cell(ys[i]) << 21 | cell(zs[i]) << 42).second)
+                {
+                    continue;
+                }
+            }
+            ch_vertex& point {points.emplace_back()};
+            point.x = xs[i];
+            point.y = ys[i];
+            point.z = zs[i];
+        }
+        return points;
+    }
+}
+
+int HullBuilder::build(const std::span<const glm::vec3> positions, const std::span<const std::uint32_t> members, const bool prefilter,
+                       std::vector<glm::dvec3>& corners)
+{
+    corners.clear();
+    // the library's scratch memory & output live in the arena, so nothing leaks if the build fails
+    HullArena arena{};
+    std::vector<ch_vertex> points {getHullCandidates(positions, members, prefilter, arena)};
+    int* faces {nullptr};
+    int numFaces{0};
+    convhull_3d_build_alloc(points.data(), static_cast<int>(points.size()), &faces, &numFaces, &arena);
+    if (faces != nullptr)
+    {
+        corners.reserve(static_cast<std::size_t>(numFaces) * 3);
+        for (int i{0}; i < numFaces * 3; ++i)
+        {
+            const ch_vertex& point {points[faces[i]]};
+            corners.emplace_back(point.x, point.y, point.z);
+        }
+    }
+    return static_cast<int>(points.size());
+}
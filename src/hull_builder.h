@@ -0,0 +1,24 @@
+/*
+ * Convex hulls of clusters of papers (convhull_3d), without any rendering, so they can be built on worker threads
+ * & checked on their own. Large clusters are prefiltered first: papers strictly inside the polytope spanned by
+ * the extreme papers along 26 directions can't be hull vertices, so they're left out (Akl-Toussaint).
+ */
+
+#ifndef HULL_BUILDER_H
+#define HULL_BUILDER_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace HullBuilder
+{
+    // corners of the triangles of the convex hull of the members' positions (3 per face, counter-clockwise seen
+    // from outside), empty if the papers don't span a volume
+    // returns the number of papers the hull was built from (after the prefilter, if enabled)
+    int build(std::span<const glm::vec3> positions, std::span<const std::uint32_t> members, bool prefilter, std::vector<glm::dvec3>& corners);
+}
+
+#endif
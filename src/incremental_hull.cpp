@@ -0,0 +1,431 @@
+#include "incremental_hull.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    constexpr std::uint32_t NO_FACE {std::numeric_limits<std::uint32_t>::max()};
+    // tolerance of the visibility tests, relative to the size of the point set
+    constexpr double HULL_EPSILON {1e-9};
+    // seed of the insertion order, fixed so the hulls are the same every run
+    constexpr std::uint64_t HULL_SEED {0x68756C6C73ull};
+    // times a point is moved further out (by 2, 4, 8... epsilon) before the hull is rebuilt instead
+    constexpr int MAX_PERTURBATIONS {4};
+    // every rebuild multiplies the tolerance by this, up to HULL_EPSILON * 16^4 (well below a paper's size)
+    constexpr double EPSILON_GROWTH {16.0};
+    constexpr int MAX_REBUILDS {4};
+}
+
+void IncrementalHull::reset(const std::span<const glm::vec3> positions, const std::span<const std::uint32_t> members)
+{
+    m_points.resize(members.size());
+    for (std::size_t i{0}; i < members.size(); ++i)
+    {
+        m_points[i] = glm::dvec3{positions[members[i]]};
+    }
+    m_pointConflicts.assign(members.size(), {});
+    m_inserted.assign(members.size(), 0);
+    m_faces.clear();
+    m_faceMarks.clear();
+    m_pointMarks.assign(members.size(), 0);
+    m_mark = 0;
+    m_numInserted = 0;
+    m_random = HULL_SEED;
+
+    glm::dvec3 min {m_points.empty() ? glm::dvec3{0.0} : m_points[0]};
+    glm::dvec3 max {min};
+    for (const glm::dvec3& point : m_points)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    m_epsilon = HULL_EPSILON * glm::length(max - min);
+    m_hasSimplex = findSimplex();
+    if (m_hasSimplex)
+    {
+        buildSimplex();
+    }
+}
+
+bool IncrementalHull::insertUpTo(std::size_t count)
+{
+    count = std::min(count, m_points.size());
+    if (count <= m_numInserted)
+    {
+        return false;
+    }
+    const std::size_t first {m_numInserted};
+    m_numInserted = count;
+    if (!m_hasSimplex)
+    {
+        return false;
+    }
+    // the hull of the new points doesn't depend on their order, so they're shuffled (fisher-yates)
+    m_batch.resize(count - first);
+    for (std::size_t i{0}; i < m_batch.size(); ++i)
+    {
+        m_batch[i] = static_cast<std::uint32_t>(first + i);
+    }
+    for (std::size_t i{m_batch.size()}; i > 1; --i)
+    {
+        std::swap(m_batch[i - 1], m_batch[nextRandom(i)]);
+    }
+    bool changed{false};
+    for (const std::uint32_t point : m_batch)
+    {
+        changed |= insert(point);
+    }
+    // the simplex (& the points inserted before) only show up once its last corner is in
+    return (changed && hasVolume()) || (first <= m_lastSimplexPoint && m_lastSimplexPoint < count);
+}
+
+bool IncrementalHull::hasVolume() const
+{
+    return m_hasSimplex && m_numInserted > m_lastSimplexPoint;
+}
+
+void IncrementalHull::getTriangles(std::vector<glm::dvec3>& corners) const
+{
+    corners.clear();
+    if (!hasVolume())
+    {
+        return;
+    }
+    for (const Face& face : m_faces)
+    {
+        if (face.alive)
+        {
+            corners.push_back(m_points[face.v[0]]);
+            corners.push_back(m_points[face.v[1]]);
+            corners.push_back(m_points[face.v[2]]);
+        }
+    }
+}
+
+double IncrementalHull::getDistance(const Face& face, const std::uint32_t point) const
+{
+    return glm::dot(face.normal, m_points[point]) - face.offset;
+}
+
+std::uint32_t IncrementalHull::addFace(const std::uint32_t a, const std::uint32_t b, const std::uint32_t c)
+{
+    Face& face {m_faces.emplace_back()};
+    face.v[0] = a;
+    face.v[1] = b;
+    face.v[2] = c;
+    std::fill(std::begin(face.adjacent), std::end(face.adjacent), NO_FACE);
+    const glm::dvec3 normal {glm::cross(m_points[b] - m_points[a], m_points[c] - m_points[a])};
+    const double length {glm::length(normal)};
+    // a degenerate face is never visible
+    face.normal = length > 0.0 ? normal / length : glm::dvec3{0.0};
+    face.offset = glm::dot(face.normal, m_points[a]);
+    face.alive = true;
+    m_faceMarks.push_back(0);
+    return static_cast<std::uint32_t>(m_faces.size() - 1);
+}
+
+std::uint32_t IncrementalHull::nextMark()
+{
+    if (++m_mark == 0)
+    {
+        std::fill(m_faceMarks.begin(), m_faceMarks.end(), 0);
+        std::fill(m_pointMarks.begin(), m_pointMarks.end(), 0);
+        m_mark = 1;
+    }
+    return m_mark;
+}
+
+std::size_t IncrementalHull::nextRandom(const std::size_t count)
+{
+    // splitmix64
+    std::uint64_t z {m_random += 0x9E3779B97F4A7C15ull};
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<std::size_t>((z ^ (z >> 31)) % count);
+}
+
+bool IncrementalHull::findSimplex()
+{
+    const std::size_t numPoints {m_points.size()};
+    if (numPoints < 4)
+    {
+        return false;
+    }
+    // first point that differs from the first one, isn't on the line through them & isn't on the plane through them
+    std::size_t i1{1};
+    while (i1 < numPoints && glm::length(m_points[i1] - m_points[0]) <= m_epsilon)
+    {
+        ++i1;
+    }
+    const glm::dvec3 edge {i1 < numPoints ? m_points[i1] - m_points[0] : glm::dvec3{0.0}};
+    std::size_t i2 {i1 + 1};
+    while (i2 < numPoints && glm::length(glm::cross(edge, m_points[i2] - m_points[0])) <= m_epsilon * glm::length(edge))
+    {
+        ++i2;
+    }
+    if (i2 >= numPoints)
+    {
+        return false;
+    }
+    const glm::dvec3 normal {glm::normalize(glm::cross(edge, m_points[i2] - m_points[0]))};
+    std::size_t i3 {i2 + 1};
+    while (i3 < numPoints && std::abs(glm::dot(normal, m_points[i3] - m_points[0])) <= m_epsilon)
+    {
+        ++i3;
+    }
+    if (i3 >= numPoints)
+    {
+        return false;
+    }
+    m_simplex[0] = 0;
+    m_simplex[1] = static_cast<std::uint32_t>(i1);
+    m_simplex[2] = static_cast<std::uint32_t>(i2);
+    m_simplex[3] = static_cast<std::uint32_t>(i3);
+    m_lastSimplexPoint = i3;
+    return true;
+}
+
+void IncrementalHull::buildSimplex()
+{
+    // each face with the corner it's opposite of, faces are flipped to point away from it
+    const std::uint32_t (&corners)[4] {m_simplex};
+    for (std::size_t f{0}; f < 4; ++f)
+    {
+        std::uint32_t v[3];
+        std::size_t n{0};
+        for (std::size_t c{0}; c < 4; ++c)
+        {
+            if (c != 3 - f)
+            {
+                v[n++] = corners[c];
+            }
+        }
+        const std::uint32_t face {addFace(v[0], v[1], v[2])};
+        if (getDistance(m_faces[face], corners[3 - f]) > 0.0)
+        {
+            std::swap(m_faces[face].v[1], m_faces[face].v[2]);
+            m_faces[face].normal = -m_faces[face].normal;
+            m_faces[face].offset = -m_faces[face].offset;
+        }
+    }
+    // every edge is shared with the face that has it the other way around
+    for (Face& face : m_faces)
+    {
+        for (std::size_t e{0}; e < 3; ++e)
+        {
+            for (std::uint32_t other{0}; other < 4; ++other)
+            {
+                const Face& otherFace {m_faces[other]};
+                for (std::size_t o{0}; o < 3; ++o)
+                {
+                    if (otherFace.v[o] == face.v[(e + 1) % 3] && otherFace.v[(o + 1) % 3] == face.v[e])
+                    {
+                        face.adjacent[e] = other;
+                    }
+                }
+            }
+        }
+    }
+
+    // conflict graph of the other points, the corners count as inserted
+    for (const std::uint32_t corner : corners)
+    {
+        m_inserted[corner] = 1;
+    }
+    for (std::uint32_t point{0}; point < m_points.size(); ++point)
+    {
+        if (m_inserted[point])
+        {
+            continue;
+        }
+        for (std::uint32_t face{0}; face < 4; ++face)
+        {
+            if (getDistance(m_faces[face], point) > m_epsilon)
+            {
+                m_faces[face].conflicts.push_back(point);
+                m_pointConflicts[point].push_back(face);
+            }
+        }
+    }
+}
+
+bool IncrementalHull::insert(const std::uint32_t point)
+{
+    m_inserted[point] = 1;
+    std::vector<std::uint32_t>& seen {m_pointConflicts[point]};
+    for (int attempt{0}; attempt <= MAX_PERTURBATIONS; ++attempt)
+    {
+        // start from the furthest face the point sees, that's still part of the hull
+        std::uint32_t start {NO_FACE};
+        double furthest{0.0};
+        for (const std::uint32_t face : seen)
+        {
+            const double distance {getDistance(m_faces[face], point)};
+            if (m_faces[face].alive && distance > furthest)
+            {
+                start = face;
+                furthest = distance;
+            }
+        }
+        if (start == NO_FACE)
+        {
+            // inside the hull
+            seen = {};
+            return false;
+        }
+        if (addCone(point, start))
+        {
+            seen = {};
+            return true;
+        }
+        // nearly coplanar faces, moved out of the hull a little further each time they still don't form a disk
+        m_points[point] += m_faces[start].normal * (m_epsilon * static_cast<double>(2 << attempt));
+    }
+    // the rebuild that's running is started again with a coarser tolerance
+    if (m_rebuilding)
+    {
+        m_rebuildFailed = true;
+        seen = {};
+        return false;
+    }
+    rebuild();
+    return true;
+}
+
+bool IncrementalHull::addCone(const std::uint32_t point, const std::uint32_t start)
+{
+    // visible faces connected to the start
+    const std::uint32_t visibleMark {nextMark()};
+    m_visible.clear();
+    m_visible.push_back(start);
+    m_faceMarks[start] = visibleMark;
+    for (std::size_t i{0}; i < m_visible.size(); ++i)
+    {
+        for (const std::uint32_t adjacent : m_faces[m_visible[i]].adjacent)
+        {
+            // faces the point is (nearly) on the plane of are replaced too, or the new faces can fold over them
+            if (m_faceMarks[adjacent] != visibleMark && getDistance(m_faces[adjacent], point) >= -m_epsilon)
+            {
+                m_faceMarks[adjacent] = visibleMark;
+                m_visible.push_back(adjacent);
+            }
+        }
+    }
+
+    // edges between visible & hidden faces, followed around as a loop
+    m_horizon.clear();
+    for (const std::uint32_t face : m_visible)
+    {
+        for (std::size_t e{0}; e < 3; ++e)
+        {
+            const Face& visible {m_faces[face]};
+            if (m_faceMarks[visible.adjacent[e]] != visibleMark)
+            {
+                m_horizon.push_back({visible.v[e], visible.v[(e + 1) % 3], face, visible.adjacent[e]});
+            }
+        }
+    }
+    std::ranges::sort(m_horizon, {}, &HorizonEdge::a);
+    m_loop.clear();
+    std::uint32_t corner {m_horizon.front().a};
+    do
+    {
+        const auto next {std::ranges::lower_bound(m_horizon, corner, {}, &HorizonEdge::a)};
+        // the visible faces don't form a disk (nearly coplanar faces)
+        if (next == m_horizon.end() || next->a != corner || m_loop.size() == m_horizon.size())
+        {
+            return false;
+        }
+        m_loop.push_back(*next);
+        corner = next->b;
+    } while (corner != m_horizon.front().a);
+    if (m_loop.size() != m_horizon.size())
+    {
+        return false;
+    }
+
+    // cone of new faces from the horizon to the point
+    const std::uint32_t first {static_cast<std::uint32_t>(m_faces.size())};
+    const std::uint32_t numNew {static_cast<std::uint32_t>(m_loop.size())};
+    for (std::uint32_t k{0}; k < numNew; ++k)
+    {
+        const HorizonEdge& edge {m_loop[k]};
+        const std::uint32_t face {addFace(edge.a, edge.b, point)};
+        m_faces[face].adjacent[0] = edge.outside;
+        m_faces[face].adjacent[1] = first + (k + 1) % numNew;
+        m_faces[face].adjacent[2] = first + (k + numNew - 1) % numNew;
+        Face& outside {m_faces[edge.outside]};
+        for (std::size_t e{0}; e < 3; ++e)
+        {
+            if (outside.v[e] == edge.b && outside.v[(e + 1) % 3] == edge.a)
+            {
+                outside.adjacent[e] = face;
+            }
+        }
+
+        // a point sees the new face only if it saw one of the faces on either side of the horizon edge
+        const std::uint32_t mark {nextMark()};
+        for (const std::uint32_t side : {edge.inside, edge.outside})
+        {
+            for (const std::uint32_t candidate : m_faces[side].conflicts)
+            {
+                // skip points inserted since (& point itself)
+                if (!m_inserted[candidate] && m_pointMarks[candidate] != mark)
+                {
+                    m_pointMarks[candidate] = mark;
+                    if (getDistance(m_faces[face], candidate) > m_epsilon)
+                    {
+                        m_faces[face].conflicts.push_back(candidate);
+                        m_pointConflicts[candidate].push_back(face);
+                    }
+                }
+            }
+        }
+    }
+
+    for (const std::uint32_t face : m_visible)
+    {
+        m_faces[face].alive = false;
+        m_faces[face].conflicts = {};
+    }
+    return true;
+}
+
+void IncrementalHull::rebuild()
+{
+    std::vector<std::uint32_t> points;
+    for (std::uint32_t point{0}; point < m_points.size(); ++point)
+    {
+        if (m_inserted[point])
+        {
+            points.push_back(point);
+        }
+    }
+    // nearly flat regions (points within a few epsilon of each other's faces) can fold over themselves, a coarser
+    // tolerance makes them flat (the points of the last try that still fail are left out)
+    for (int attempt{0}; attempt < MAX_REBUILDS; ++attempt)
+    {
+        m_epsilon *= EPSILON_GROWTH;
+        m_faces.clear();
+        m_faceMarks.clear();
+        m_pointConflicts.assign(m_points.size(), {});
+        std::ranges::fill(m_inserted, 0);
+        buildSimplex();
+        for (std::size_t i{points.size()}; i > 1; --i)
+        {
+            std::swap(points[i - 1], points[nextRandom(i)]);
+        }
+        m_rebuilding = true;
+        m_rebuildFailed = false;
+        for (const std::uint32_t point : points)
+        {
+            insert(point);
+        }
+        m_rebuilding = false;
+        if (!m_rebuildFailed)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * Convex hull that grows one point at a time (randomized incremental construction with a conflict graph).
+ * All the points are known up front, so every face keeps the pending points that can see it & every pending
+ * point the faces it sees. Points inside the hull cost O(1) to insert, others replace the faces they see.
+ * The hull only ever contains a prefix of the points, the points added to it at once are inserted in a seeded
+ * random order, so sorted input (e.g. along an axis) doesn't make every insert replace most of the hull.
+ */
+
+#ifndef INCREMENTAL_HULL_H
+#define INCREMENTAL_HULL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class IncrementalHull
+{
+public:
+    // forget the hull & insert prefixes of positions[members] with insertUpTo()
+    void reset(std::span<const glm::vec3> positions, std::span<const std::uint32_t> members);
+
+    // inserts the points before count (the new ones in random order), returns true if the faces changed
+    bool insertUpTo(std::size_t count);
+
+    [[nodiscard]] std::size_t getNumInserted() const {return m_numInserted;}
+    [[nodiscard]] std::size_t getNumPoints() const {return m_points.size();}
+    // false until the inserted points span a volume
+    [[nodiscard]] bool hasVolume() const;
+    // corners of the faces (counter-clockwise seen from outside), 3 per face
+    void getTriangles(std::vector<glm::dvec3>& corners) const;
+
+private:
+    struct Face
+    {
+        // corners
+        std::uint32_t v[3];
+        // face across the edge v[i] -> v[(i + 1) % 3]
+        std::uint32_t adjacent[3];
+        glm::dvec3 normal;
+        double offset;
+        bool alive;
+        // pending points that see this face (points inserted since are skipped)
+        std::vector<std::uint32_t> conflicts;
+    };
+
+    // horizon edge a -> b of the visible faces, outside is the face across it that stays
+    struct HorizonEdge
+    {
+        std::uint32_t a;
+        std::uint32_t b;
+        std::uint32_t inside;
+        std::uint32_t outside;
+    };
+
+    [[nodiscard]] double getDistance(const Face& face, std::uint32_t point) const;
+    std::uint32_t addFace(std::uint32_t a, std::uint32_t b, std::uint32_t c);
+    // new mark for m_faceMarks & m_pointMarks
+    std::uint32_t nextMark();
+    // finds the first 4 points that span a volume (m_simplex), returns false if there are none
+    bool findSimplex();
+    // builds the tetrahedron from m_simplex & the conflict graph of the other points
+    void buildSimplex();
+    // insert point, nearly coplanar faces can make the faces it sees not form a disk, then it's moved out a
+    // little & tried again (& the hull is rebuilt with a coarser tolerance if that doesn't help), returns true if
+    // the faces changed
+    bool insert(std::uint32_t point);
+    // replace start & the faces connected to it that point sees with a cone to point, returns false (without
+    // changing the hull) if they don't form a disk
+    bool addCone(std::uint32_t point, std::uint32_t start);
+    // build the hull of the inserted points again, in a new random order & with a coarser tolerance
+    void rebuild();
+    // random index in [0, count)
+    std::size_t nextRandom(std::size_t count);
+
+    std::vector<glm::dvec3> m_points;
+    // faces (possibly deleted ones) each pending point sees
+    std::vector<std::vector<std::uint32_t>> m_pointConflicts;
+    std::vector<Face> m_faces;
+    // points [0, m_numInserted) are in the hull
+    std::size_t m_numInserted{0};
+    // whether each point is in the hull (or a corner of the simplex)
+    std::vector<std::uint8_t> m_inserted;
+    // corners of the simplex, the hull is only complete once the last one is inserted
+    std::uint32_t m_simplex[4]{};
+    std::size_t m_lastSimplexPoint{0};
+    bool m_hasSimplex{false};
+    // points closer than this to a face's plane don't see it
+    double m_epsilon{0.0};
+    // state of the random insertion order, seeded by reset()
+    std::uint64_t m_random{0};
+    // set while rebuild() inserts the points again & if any of them failed
+    bool m_rebuilding{false};
+    bool m_rebuildFailed{false};
+
+    // scratch space for insert()
+    std::vector<std::uint32_t> m_faceMarks;
+    std::vector<std::uint32_t> m_pointMarks;
+    std::uint32_t m_mark{0};
+    std::vector<std::uint32_t> m_visible;
+    std::vector<HorizonEdge> m_horizon;
+    std::vector<HorizonEdge> m_loop;
+    std::vector<std::uint32_t> m_batch;
+};
+
+#endif
@@ -0,0 +1,362 @@
+#include "kmeans.h"
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+
+namespace
+{
+    // points per task, chunks are fixed so partial sums (& the result) don't depend on the number of threads
+    constexpr std::size_t CHUNK_SIZE {1 << 14};
+
+    // splitmix64, small & fast enough for seeding
+    class Random
+    {
+    public:
+        explicit Random(const std::uint64_t seed) : m_state{seed} {}
+
+        std::uint64_t next()
+        {
+            std::uint64_t z {m_state += 0x9E3779B97F4A7C15ull};
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        // [0, 1)
+        double uniform() {return static_cast<double>(next() >> 11) * 0x1.0p-53;}
+
+    private:
+        std::uint64_t m_state;
+    };
+
+    // points or centroids as structure of arrays, so distance loops vectorize
+    struct Coordinates
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+
+        void push(const float px, const float py, const float pz)
+        {
+            x.push_back(px);
+            y.push_back(py);
+            z.push_back(pz);
+        }
+        [[nodiscard]] std::size_t size() const {return x.size();}
+    };
+
+    float getDistance2(const Coordinates& a, const std::size_t i, const Coordinates& b, const std::size_t j)
+    {
+        const float dx {a.x[i] - b.x[j]};
+        const float dy {a.y[i] - b.y[j]};
+        const float dz {a.z[i] - b.z[j]};
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // squared distances from point i to every centroid
+    void getDistances2(const Coordinates& points, const std::size_t i, const Coordinates& centroids, float* const distances)
+    {
+        const float px {points.x[i]};
+        const float py {points.y[i]};
+        const float pz {points.z[i]};
+        const float* const cx {centroids.x.data()};
+        const float* const cy {centroids.y.data()};
+        const float* const cz {centroids.z.data()};
+        const std::size_t k {centroids.size()};
+        for (std::size_t j{0}; j < k; ++j)
+        {
+            const float dx {cx[j] - px};
+            const float dy {cy[j] - py};
+            const float dz {cz[j] - pz};
+            distances[j] = dx * dx + dy * dy + dz * dz;
+        }
+    }
+
+    // run task(chunk, first, last) for the chunks of [0, size) on the shared pool
+    template <typename F>
+    void forChunks(const std::size_t size, const F& task)
+    {
+        const std::size_t numChunks {(size + CHUNK_SIZE - 1) / CHUNK_SIZE};
+        ThreadPool& pool {ThreadPool::shared()};
+        if (numChunks <= 1 || pool.size() <= 1)
+        {
+            for (std::size_t chunk{0}; chunk < numChunks; ++chunk)
+            {
+                task(chunk, chunk * CHUNK_SIZE, std::min(size, (chunk + 1) * CHUNK_SIZE));
+            }
+            return;
+        }
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(numChunks);
+        for (std::size_t chunk{0}; chunk < numChunks; ++chunk)
+        {
+            tasks.push_back(pool.submit([&task, chunk, size] {
+                task(chunk, chunk * CHUNK_SIZE, std::min(size, (chunk + 1) * CHUNK_SIZE));
+            }));
+        }
+        for (std::future<void>& future : tasks)
+        {
+            future.get();
+        }
+    }
+
+    // k-means++: each next centroid is a point picked with probability proportional to its squared distance
+    // to the closest centroid so far
+    Coordinates seedCentroids(const Coordinates& points, const std::size_t k, Random& random)
+    {
+        const std::size_t numPoints {points.size()};
+        const std::size_t numChunks {(numPoints + CHUNK_SIZE - 1) / CHUNK_SIZE};
+        Coordinates centroids;
+        std::size_t pick {random.next() % numPoints};
+        centroids.push(points.x[pick], points.y[pick], points.z[pick]);
+        std::vector<float> closest(numPoints, std::numeric_limits<float>::max());
+        std::vector<double> chunkSums(numChunks);
+        while (centroids.size() < k)
+        {
+            const std::size_t last {centroids.size() - 1};
+            forChunks(numPoints, [&](const std::size_t chunk, const std::size_t first, const std::size_t end) {
+                for (std::size_t i{first}; i < end; ++i)
+                {
+                    closest[i] = std::min(closest[i], getDistance2(points, i, centroids, last));
+                }
+                double sum{0.0};
+                for (std::size_t i{first}; i < end; ++i)
+                {
+                    sum += closest[i];
+                }
+                chunkSums[chunk] = sum;
+            });
+
+            double total{0.0};
+            for (const double sum : chunkSums)
+            {
+                total += sum;
+            }
+            if (total <= 0.0)
+            {
+                // every point sits on a centroid already
+                pick = random.next() % numPoints;
+            } else
+            {
+                double target {random.uniform() * total};
+                std::size_t chunk{0};
+                while (chunk + 1 < numChunks && target >= chunkSums[chunk])
+                {
+                    target -= chunkSums[chunk++];
+                }
+                const std::size_t end {std::min(numPoints, (chunk + 1) * CHUNK_SIZE)};
+                pick = chunk * CHUNK_SIZE;
+                while (pick + 1 < end && target >= closest[pick])
+                {
+                    target -= closest[pick++];
+                }
+            }
+            centroids.push(points.x[pick], points.y[pick], points.z[pick]);
+        }
+        return centroids;
+    }
+
+    KMeans::Result cluster(const Coordinates& points, const KMeans::Settings& settings)
+    {
+        KMeans::Result result{};
+        const std::size_t numPoints {points.size()};
+        if (numPoints == 0)
+        {
+            return result;
+        }
+        const std::size_t k {static_cast<std::size_t>(std::clamp(settings.k, 1, static_cast<int>(std::min<std::size_t>(numPoints, KMeans::MAX_CLUSTERS))))};
+        Random random{settings.seed};
+        Coordinates centroids {seedCentroids(points, k, random)};
+        glm::vec3 min {points.x[0], points.y[0], points.z[0]};
+        glm::vec3 max {min};
+        for (std::size_t i{0}; i < numPoints; ++i)
+        {
+            const glm::vec3 point {points.x[i], points.y[i], points.z[i]};
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+        const float tolerance {settings.tolerance * glm::length(max - min)};
+
+        // distance to the assigned centroid (upper bound) & to the closest other one (lower bound), upper = infinity
+        // makes the first iteration assign every point
+        std::vector<std::uint16_t>& assignments {result.assignments};
+        assignments.assign(numPoints, 0);
+        std::vector<float> upper(numPoints, std::numeric_limits<float>::infinity());
+        std::vector<float> lower(numPoints, 0.0f);
+        // half the distance from each centroid to the closest other one, points closer than that can't change
+        std::vector<float> half(k);
+        std::vector<float> moved(k);
+        const std::size_t numChunks {(numPoints + CHUNK_SIZE - 1) / CHUNK_SIZE};
+        std::vector<glm::dvec3> chunkSums(numChunks * k);
+        std::vector<std::uint32_t> chunkCounts(numChunks * k);
+        std::vector<std::uint32_t> chunkChanged(numChunks);
+        std::vector<std::uint64_t> chunkDistances(numChunks);
+        // once the centroids settle, points are assigned to them one last time
+        bool lastPass{false};
+
+        for (result.iterations = 1; result.iterations <= settings.maxIterations; ++result.iterations)
+        {
+            for (std::size_t j{0}; j < k; ++j)
+            {
+                float closest {std::numeric_limits<float>::max()};
+                for (std::size_t other{0}; other < k; ++other)
+                {
+                    if (other != j)
+                    {
+                        closest = std::min(closest, getDistance2(centroids, j, centroids, other));
+                    }
+                }
+                half[j] = 0.5f * std::sqrt(closest);
+            }
+
+            // assignment, papers are summed per chunk for the update step
+            forChunks(numPoints, [&](const std::size_t chunk, const std::size_t first, const std::size_t end) {
+                glm::dvec3* const sums {chunkSums.data() + chunk * k};
+                std::uint32_t* const counts {chunkCounts.data() + chunk * k};
+                std::fill(sums, sums + k, glm::dvec3{0.0});
+                std::fill(counts, counts + k, 0);
+                std::vector<float> distances(k);
+                std::uint32_t changed{0};
+                std::uint64_t numDistances{0};
+                for (std::size_t i{first}; i < end; ++i)
+                {
+                    std::uint16_t assigned {assignments[i]};
+                    const float bound {std::max(half[assigned], lower[i])};
+                    if (upper[i] > bound)
+                    {
+                        // tighten the upper bound first, it's often enough
+                        upper[i] = std::sqrt(getDistance2(points, i, centroids, assigned));
+                        ++numDistances;
+                        if (upper[i] > bound)
+                        {
+                            getDistances2(points, i, centroids, distances.data());
+                            numDistances += k;
+                            std::size_t best{0};
+                            float bestDistance {std::numeric_limits<float>::infinity()};
+                            float secondDistance {std::numeric_limits<float>::infinity()};
+                            for (std::size_t j{0}; j < k; ++j)
+                            {
+                                if (distances[j] < bestDistance)
+                                {
+                                    secondDistance = bestDistance;
+                                    bestDistance = distances[j];
+                                    best = j;
+                                } else if (distances[j] < secondDistance)
+                                {
+                                    secondDistance = distances[j];
+                                }
+                            }
+                            if (best != assigned)
+                            {
+                                assigned = static_cast<std::uint16_t>(best);
+                                assignments[i] = assigned;
+                                ++changed;
+                            }
+                            upper[i] = std::sqrt(bestDistance);
+                            lower[i] = std::sqrt(secondDistance);
+                        }
+                    }
+                    sums[assigned] += glm::dvec3{points.x[i], points.y[i], points.z[i]};
+                    ++counts[assigned];
+                }
+                chunkChanged[chunk] = changed;
+                chunkDistances[chunk] = numDistances;
+            });
+            std::uint64_t changed{0};
+            for (std::size_t chunk{0}; chunk < numChunks; ++chunk)
+            {
+                changed += chunkChanged[chunk];
+                result.numDistances += chunkDistances[chunk];
+            }
+            // the first iteration always moves points (from cluster 0), the centroids are from the last assignment
+            if ((changed == 0 && result.iterations > 1) || lastPass)
+            {
+                result.converged = true;
+                break;
+            }
+
+            // update, empty clusters keep their centroid
+            for (std::size_t j{0}; j < k; ++j)
+            {
+                glm::dvec3 sum{0.0};
+                std::uint64_t count{0};
+                for (std::size_t chunk{0}; chunk < numChunks; ++chunk)
+                {
+                    sum += chunkSums[chunk * k + j];
+                    count += chunkCounts[chunk * k + j];
+                }
+                moved[j] = 0.0f;
+                if (count > 0)
+                {
+                    const glm::vec3 centroid {sum / static_cast<double>(count)};
+                    const glm::vec3 old {centroids.x[j], centroids.y[j], centroids.z[j]};
+                    moved[j] = glm::length(centroid - old);
+                    centroids.x[j] = centroid.x;
+                    centroids.y[j] = centroid.y;
+                    centroids.z[j] = centroid.z;
+                }
+            }
+
+            // loosen the bounds by how far the centroids moved
+            std::size_t furthest{0};
+            for (std::size_t j{1}; j < k; ++j)
+            {
+                furthest = moved[j] > moved[furthest] ? j : furthest;
+            }
+            lastPass = moved[furthest] <= tolerance;
+            float secondMoved{0.0f};
+            for (std::size_t j{0}; j < k; ++j)
+            {
+                secondMoved = j != furthest ? std::max(secondMoved, moved[j]) : secondMoved;
+            }
+            forChunks(numPoints, [&](std::size_t, const std::size_t first, const std::size_t end) {
+                for (std::size_t i{first}; i < end; ++i)
+                {
+                    upper[i] += moved[assignments[i]];
+                    lower[i] -= assignments[i] == furthest ? secondMoved : moved[furthest];
+                }
+            });
+        }
+        result.iterations = std::min(result.iterations, settings.maxIterations);
+
+        result.centroids.resize(k);
+        for (std::size_t j{0}; j < k; ++j)
+        {
+            result.centroids[j] = {centroids.x[j], centroids.y[j], centroids.z[j]};
+        }
+        return result;
+    }
+}
+
+KMeans::Result KMeans::run(const std::span<const glm::vec3> points, const Settings& settings)
+{
+    Coordinates coordinates;
+    coordinates.x.resize(points.size());
+    coordinates.y.resize(points.size());
+    coordinates.z.resize(points.size());
+    for (std::size_t i{0}; i < points.size(); ++i)
+    {
+        coordinates.x[i] = points[i].x;
+        coordinates.y[i] = points[i].y;
+        coordinates.z[i] = points[i].z;
+    }
+    return cluster(coordinates, settings);
+}
+
+KMeans::Result KMeans::run(const std::span<const glm::vec2> points, const Settings& settings)
+{
+    Coordinates coordinates;
+    coordinates.x.resize(points.size());
+    coordinates.y.resize(points.size());
+    coordinates.z.assign(points.size(), 0.0f);
+    for (std::size_t i{0}; i < points.size(); ++i)
+    {
+        coordinates.x[i] = points[i].x;
+        coordinates.y[i] = points[i].y;
+    }
+    return cluster(coordinates, settings);
+}
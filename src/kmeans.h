@@ -0,0 +1,51 @@
+/*
+ * k-means clustering of paper positions, so clusters of any granularity can be explored in the app.
+ * Seeded with k-means++ and iterated with Hamerly's algorithm: bounds on the distances to the closest & second
+ * closest centroid let most points skip the distance computations. Assignment & update steps are split across
+ * the shared thread pool.
+ */
+
+#ifndef KMEANS_H
+#define KMEANS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace KMeans
+{
+    // cluster ids are stored in 16 bits, & the distance table of the centroids grows with k^2
+    constexpr int MAX_CLUSTERS {4096};
+
+    struct Settings
+    {
+        int k{8};
+        int maxIterations{100};
+        // also stop once no centroid moves further than this (relative to the size of the point set),
+        // the last few iterations of k-means tend to shuffle a handful of points back & forth
+        float tolerance{1e-4f};
+        std::uint64_t seed{0x6B6D65616E73ull};
+    };
+
+    struct Result
+    {
+        // cluster of each point
+        std::vector<std::uint16_t> assignments{};
+        std::vector<glm::vec3> centroids{};
+        int iterations{0};
+        // false if maxIterations was reached before the assignments (or centroids) stopped changing
+        bool converged{false};
+        // point to centroid distances computed (a naive implementation computes points * k per iteration)
+        std::uint64_t numDistances{0};
+    };
+
+    // k is clamped to [1, min(number of points, MAX_CLUSTERS)], the result is the same for any number of threads
+    [[nodiscard]] Result run(std::span<const glm::vec3> points, const Settings& settings);
+    // 2D points are clustered as 3D points with z = 0
+    [[nodiscard]] Result run(std::span<const glm::vec2> points, const Settings& settings);
+}
+
+#endif
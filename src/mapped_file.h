@@ -0,0 +1,46 @@
+/*
+ * Read-only memory mapped file, used for loading large data files without copying them.
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    // mapping is owned, so only allow moving
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // map whole file into memory (read only), returns false on failure
+    bool open(const std::string& path);
+    void close();
+
+    [[nodiscard]] bool isOpen() const {return m_open;}
+    [[nodiscard]] const char* data() const {return m_data;}
+    [[nodiscard]] std::size_t size() const {return m_size;}
+    [[nodiscard]] std::string_view view() const {return {m_data, m_size};}
+
+private:
+    const char* m_data{nullptr};
+    std::size_t m_size{0};
+    // empty files can't be mapped (m_data stays null), but are still valid
+    bool m_open{false};
+
+#ifdef _WIN32
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#endif
+};
+
+#endif
@@ -247,6 +247,12 @@ void App::drawTexture(const Texture *texture, const FRect destination) const
 
 void App::mouse_callback(GLFWwindow *window, const double xPosIn, const double yPosIn)
 {
+    // the cursor is free (e.g. for picking), so it doesn't move the camera
+    if (!_cameraEnabled)
+    {
+        _camFirstMouse = true;
+        return;
+    }
     const float xPos{static_cast<float>(xPosIn)};
     const float yPos{static_cast<float>(yPosIn)};
 
@@ -91,7 +91,7 @@ void FontManager::free()
     }
 }
 
-void FontManager::renderText(const Shader& shader, const std::string text, float x, float y, const float scale, const glm::vec3&& color)
+void FontManager::renderText(const Shader& shader, const std::string_view text, float x, float y, const float scale, const glm::vec3&& color)
 {
     // correct blending function
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -103,7 +103,7 @@ void FontManager::renderText(const Shader& shader, const std::string text, float
     glBindVertexArray(m_VAO);
 
     // go through all the characters
-    std::string::const_iterator chr;
+    std::string_view::const_iterator chr;
     for (chr = {text.begin()}; chr != text.end(); ++chr)
     {
         Character c {m_characters[*chr]};
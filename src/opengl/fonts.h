@@ -11,6 +11,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <string_view>
 #include <map>
 
 #include "shader.h"
@@ -33,7 +34,8 @@ public:
     void free();
 
     // render text
-    void renderText(const Shader& shader, std::string text, float x, float y, float scale, const glm::vec3&& color);
+    // text is only read, so any string (or view into the paper text arena) can be drawn without a copy
+    void renderText(const Shader& shader, std::string_view text, float x, float y, float scale, const glm::vec3&& color);
 
     // update projection matrix with framebuffer dimensions on resize
     void updateProjection(float width, float height);
@@ -194,6 +194,65 @@ void Shader::addGeometryShader(const char* geometryPath) const
 }
 
 
+Shader::Shader(const char *vertexPath, const char *geometryPath, const char *fragmentPath)
+{
+    const char *paths[3] {vertexPath, geometryPath, fragmentPath};
+    const GLenum types[3] {GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER};
+    const char *names[3] {"VERTEX", "GEOMETRY", "FRAGMENT"};
+    unsigned int shaders[3];
+    int success;
+    char infoLog[512]; // for the errors
+
+    ID = glCreateProgram();
+    for (int i {0}; i < 3; ++i)
+    {
+        std::string code;
+        std::ifstream shaderFile;
+        shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            shaderFile.open(paths[i]);
+            std::stringstream shaderStream;
+            // read the buffer contents
+            shaderStream << shaderFile.rdbuf();
+            shaderFile.close();
+            code = shaderStream.str();
+        } catch ([[maybe_unused]] std::ifstream::failure &e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+        }
+        const char *shaderCode = code.c_str();
+
+        // compile the shader
+        shaders[i] = glCreateShader(types[i]);
+        glShaderSource(shaders[i], 1, &shaderCode, nullptr);
+        glCompileShader(shaders[i]);
+        glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(shaders[i], 512, nullptr, infoLog);
+            std::cout << "ERROR::SHADER::" << names[i] << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        glAttachShader(ID, shaders[i]);
+    }
+
+    // shader program
+    glLinkProgram(ID);
+    // get linking errors
+    glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(ID, 512, nullptr, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+
+    // we no longer need them
+    for (const unsigned int shader : shaders)
+    {
+        glDeleteShader(shader);
+    }
+}
+
 void Shader::use() const
 {
     glUseProgram(ID);
@@ -214,6 +273,11 @@ void Shader::setInt(const std::string &name, const int value) const
     glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
 }
 
+void Shader::setUInt(const std::string &name, const unsigned int value) const
+{
+    glUniform1ui(glGetUniformLocation(ID, name.c_str()), value);
+}
+
 void Shader::setFloat(const std::string &name, const float value) const
 {
     glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
@@ -36,6 +36,9 @@ public:
 
     Shader(bool source, const char *vert_shader_source, const char *frag_shader_source);
 
+    // vertex, geometry & fragment shader (linked once, so the stages' interfaces only have to match with all three)
+    Shader(const char *vertexPath, const char *geometryPath, const char *fragmentPath);
+
     // optional geometry shader
     void addGeometryShader(const char* geometryPath) const;
 
@@ -48,6 +51,8 @@ public:
 
     void setInt(const std::string &name, int value) const;
 
+    void setUInt(const std::string &name, unsigned int value) const;
+
     void setFloat(const std::string &name, float value) const;
 
     void setVec2(const std::string &name, const glm::vec2 &value) const;
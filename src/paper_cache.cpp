@@ -0,0 +1,141 @@
+#include "paper_cache.h"
+
+#include "mapped_file.h"
+
+#include <bit>
+#include <cstdio>
+#include <filesystem>
+
+std::string PaperCache::getCachePath(const std::string& filename)
+{
+    return filename + ".pvcache";
+}
+
+bool PaperCache::getSourceInfo(const std::string& filename, const float scale, SourceInfo& info)
+{
+    std::error_code error;
+    const auto mtime {std::filesystem::last_write_time(filename, error)};
+    if (error)
+    {
+        return false;
+    }
+    const MappedFile file{filename};
+    if (!file.isOpen())
+    {
+        return false;
+    }
+    info.size = file.size();
+    info.mtime = static_cast<std::int64_t>(mtime.time_since_epoch().count());
+    info.hash = hash(file.view());
+    info.scale = scale;
+    return true;
+}
+
+namespace
+{
+    constexpr std::uint64_t PRIME_1 {0x9E3779B185EBCA87ull};
+    constexpr std::uint64_t PRIME_2 {0xC2B2AE3D27D4EB4Full};
+    constexpr std::uint64_t PRIME_3 {0x165667B19E3779F9ull};
+
+    std::uint64_t load64(const char* data)
+    {
+        std::uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    std::uint64_t hashRound(std::uint64_t acc, const std::uint64_t value)
+    {
+        acc += value * PRIME_2;
+        return std::rotl(acc, 31) * PRIME_1;
+    }
+}
+
+// four independent lanes of 8 bytes, so the multiplies can overlap (xxhash64 style)
+std::uint64_t PaperCache::hash(const std::string_view data)
+{
+    const char* it {data.data()};
+    const char* const end {data.data() + data.size()};
+    std::uint64_t lanes[4] {PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1};
+    for (; end - it >= 32; it += 32)
+    {
+        lanes[0] = hashRound(lanes[0], load64(it));
+        lanes[1] = hashRound(lanes[1], load64(it + 8));
+        lanes[2] = hashRound(lanes[2], load64(it + 16));
+        lanes[3] = hashRound(lanes[3], load64(it + 24));
+    }
+    std::uint64_t h {std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18)};
+    h += data.size();
+    for (; end - it >= 8; it += 8)
+    {
+        h = std::rotl(h ^ hashRound(0, load64(it)), 27) * PRIME_1 + PRIME_3;
+    }
+    for (; it < end; ++it)
+    {
+        h = std::rotl(h ^ (static_cast<unsigned char>(*it) * PRIME_3), 11) * PRIME_1;
+    }
+    // final avalanche
+    h ^= h >> 33;
+    h *= PRIME_2;
+    h ^= h >> 29;
+    h *= PRIME_3;
+    h ^= h >> 32;
+    return h;
+}
+
+PaperCache::Header PaperCache::makeHeader(const SourceInfo& source, const char (&magic)[8], const std::uint32_t version)
+{
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byteOrder = ENDIAN_MARKER;
+    header.scale = source.scale;
+    header.sourceSize = source.size;
+    header.sourceMtime = source.mtime;
+    header.sourceHash = source.hash;
+    return header;
+}
+
+bool PaperCache::isValid(const Header& header, const SourceInfo& source, const char (&magic)[8], const std::uint32_t version)
+{
+    return std::memcmp(header.magic, magic, sizeof(magic)) == 0 && header.version == version
+           && header.byteOrder == ENDIAN_MARKER && header.scale == source.scale
+           && header.sourceSize == source.size && header.sourceMtime == source.mtime && header.sourceHash == source.hash;
+}
+
+PaperCache::Writer::Writer(const std::string& path)
+    : m_path{path}, m_tempPath{path + ".tmp"}, m_out{m_tempPath, std::ios::binary | std::ios::trunc}
+{
+}
+
+void PaperCache::Writer::pad()
+{
+    static constexpr char zeros[ALIGNMENT]{};
+    const std::size_t padding {(ALIGNMENT - m_size % ALIGNMENT) % ALIGNMENT};
+    m_out.write(zeros, static_cast<std::streamsize>(padding));
+    m_size += padding;
+}
+
+bool PaperCache::Writer::finish()
+{
+    m_out.close();
+    std::error_code error;
+    if (m_out.fail())
+    {
+        std::filesystem::remove(m_tempPath, error);
+        return false;
+    }
+    std::filesystem::rename(m_tempPath, m_path, error);
+    return !error;
+}
+
+bool PaperCache::Reader::skipPadding()
+{
+    const std::size_t offset {(m_offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT};
+    if (offset > m_data.size())
+    {
+        return false;
+    }
+    m_offset = offset;
+    return true;
+}
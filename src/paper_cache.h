@@ -0,0 +1,155 @@
+/*
+ * Binary snapshot of the loaded papers & clusters (.pvcache), so later runs don't have to parse the csv file.
+ * The cache file is memory mapped and the paper columns are used in place.
+ */
+
+#ifndef PAPER_CACHE_H
+#define PAPER_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace PaperCache
+{
+    // bump whenever the layout changes, caches with another version are rebuilt
+    constexpr std::uint32_t VERSION {4};
+    constexpr char MAGIC[8] {'P', 'V', 'C', 'A', 'C', 'H', 'E', '\0'};
+    // arrays are aligned to this, so columns can be viewed straight from the mapped file
+    constexpr std::size_t ALIGNMENT {16};
+    // used to detect caches written on a machine with different endianness
+    constexpr std::uint32_t ENDIAN_MARKER {0x01020304};
+
+    // identifies the csv file (and load settings) the cache was built from
+    struct SourceInfo
+    {
+        std::uint64_t size{0};
+        std::int64_t mtime{0};
+        std::uint64_t hash{0};
+        float scale{0.0f};
+    };
+
+    struct Header
+    {
+        char magic[8]{};
+        std::uint32_t version{0};
+        std::uint32_t byteOrder{0};
+        float scale{0.0f};
+        std::uint32_t reserved{0};
+        std::uint64_t sourceSize{0};
+        std::int64_t sourceMtime{0};
+        std::uint64_t sourceHash{0};
+    };
+
+    // cache lives next to the csv file
+    [[nodiscard]] std::string getCachePath(const std::string& filename);
+    // size, modification time & content hash of the csv file, returns false if it can't be read
+    bool getSourceInfo(const std::string& filename, float scale, SourceInfo& info);
+    // 64-bit hash of data (not cryptographic, only used to detect changes)
+    [[nodiscard]] std::uint64_t hash(std::string_view data);
+
+    // other caches built from the papers (e.g. cluster hulls) use the same header with their own magic & version
+    [[nodiscard]] Header makeHeader(const SourceInfo& source, const char (&magic)[8] = MAGIC, std::uint32_t version = VERSION);
+    // true if the header belongs to this version & byte order & was built from source
+    [[nodiscard]] bool isValid(const Header& header, const SourceInfo& source, const char (&magic)[8] = MAGIC, std::uint32_t version = VERSION);
+
+    // writes the cache to a temporary file, which replaces the cache once finished
+    // (so a half written cache is never picked up)
+    class Writer
+    {
+    public:
+        explicit Writer(const std::string& path);
+
+        template <typename T>
+        void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            m_out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+            m_size += sizeof(T);
+        }
+
+        // element count followed by the (aligned) elements
+        template <typename T>
+        void writeArray(const std::span<const T> values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            write<std::uint64_t>(values.size());
+            pad();
+            m_out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+            m_size += values.size_bytes();
+        }
+
+        void writeString(const std::string_view str) {writeArray(std::span<const char>{str});}
+
+        // returns false if anything failed to write
+        bool finish();
+
+    private:
+        // zero bytes up to the next multiple of ALIGNMENT
+        void pad();
+
+        std::string m_path;
+        std::string m_tempPath;
+        std::ofstream m_out;
+        std::size_t m_size{0};
+    };
+
+    // reads values from a mapped cache file, arrays are returned as views into the data
+    class Reader
+    {
+    public:
+        explicit Reader(const std::string_view data) : m_data{data} {}
+
+        // returns false if there's not enough data left
+        template <typename T>
+        bool read(T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (m_data.size() - m_offset < sizeof(T))
+            {
+                return false;
+            }
+            std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+            m_offset += sizeof(T);
+            return true;
+        }
+
+        template <typename T>
+        bool readArray(std::span<const T>& values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            std::uint64_t count{0};
+            if (!read(count) || !skipPadding() || count > (m_data.size() - m_offset) / sizeof(T))
+            {
+                return false;
+            }
+            values = {reinterpret_cast<const T*>(m_data.data() + m_offset), static_cast<std::size_t>(count)};
+            m_offset += values.size_bytes();
+            return true;
+        }
+
+        bool readString(std::string_view& str)
+        {
+            std::span<const char> chars;
+            if (!readArray(chars))
+            {
+                return false;
+            }
+            str = {chars.data(), chars.size()};
+            return true;
+        }
+
+    private:
+        bool skipPadding();
+
+        std::string_view m_data;
+        std::size_t m_offset{0};
+    };
+}
+
+#endif
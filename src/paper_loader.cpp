@@ -1,178 +1,555 @@
 #include "paper_loader.h"
 
+#include "mapped_file.h"
+#include "thread_pool.h"
+#include "csv_index.h"
+
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 
 PaperLoader::PaperLoader()
 {
-    m_clusters.resize(5);
+    m_clusters.resize(NUM_CLUSTER_LEVELS);
+    m_members.resize(NUM_CLUSTER_LEVELS);
+}
+
+PaperLoader::~PaperLoader()
+{
+    // stream thread drains the batches it's parsing before it stops
+    m_streamCancel = true;
+    if (m_streamThread.joinable())
+    {
+        m_streamThread.join();
+    }
+}
+
+// instance bounds are at least this big (so a single paper doesn't divide by zero)
+constexpr float INSTANCE_MIN_SIZE {1e-3f};
+// fraction of the extent added on each side when streamed papers grow the instance bounds
+constexpr float INSTANCE_BOUNDS_MARGIN {0.25f};
+
+// chunks smaller than this aren't worth a task
+constexpr std::size_t MIN_CHUNK_SIZE {1 << 20};
+
+// load from cache if possible, otherwise parse the csv (or parquet) file & rebuild the cache
+void PaperLoader::load(const std::string& filename, const float scale)
+{
+    const auto start {std::chrono::steady_clock::now()};
+    clearKMeansClusters();
+    if (!PaperCache::getSourceInfo(filename, scale, m_source))
+    {
+        std::cerr << "Error: Failed to read file from path: `" << filename << "`" << std::endl;
+        return;
+    }
+    const std::string cachePath {PaperCache::getCachePath(filename)};
+    if (loadCache(cachePath, m_source))
+    {
+        const std::chrono::duration<double, std::milli> time {std::chrono::steady_clock::now() - start};
+        std::cout << "Loaded cache from `" << cachePath << "`. Rows: " << m_papers.size() << " | " << m_numIncluded << " included | " << m_lastIndex << " LII (" << time.count() << " ms)" << '\n';
+        return;
+    }
+    std::cout << "Cache `" << cachePath << "` is missing or stale, parsing `" << filename << "`...\n";
+    bool loaded{false};
+#ifdef PV_WITH_PARQUET
+    if (filename.ends_with(".parquet"))
+    {
+        loaded = loadFromParquet(filename, scale);
+    } else
+#endif
+    {
+        loaded = loadFromFile(filename, scale);
+    }
+    // nothing to cluster or cache if the file couldn't be read, so the next run parses it again
+    if (!loaded)
+    {
+        return;
+    }
+    generateClusters();
+    if (m_papers.empty())
+    {
+        std::cerr << "Error: No papers in `" << filename << "`, cache isn't written" << std::endl;
+    } else if (!saveCache(cachePath, m_source))
+    {
+        std::cerr << "Error: Failed to write cache to path: `" << cachePath << "`" << std::endl;
+    }
+}
+
+// open the cache or start parsing the csv file on the stream thread
+void PaperLoader::startStreaming(const std::string& filename, const float scale)
+{
+    clearKMeansClusters();
+    if (!PaperCache::getSourceInfo(filename, scale, m_source))
+    {
+        std::cerr << "Error: Failed to read file from path: `" << filename << "`" << std::endl;
+        return;
+    }
+    const std::string cachePath {PaperCache::getCachePath(filename)};
+    if (loadCache(cachePath, m_source))
+    {
+        std::cout << "Loaded cache from `" << cachePath << "`. Rows: " << m_papers.size() << " | " << m_numIncluded << " included | " << m_lastIndex << " LII" << '\n';
+        return;
+    }
+    // clear previous papers & clusters, they're rebuilt batch by batch (members once streaming is done)
+    m_papers.clear();
+    for (ClusterLevel& level : m_clusters)
+    {
+        level.clear();
+    }
+    m_members.assign(NUM_CLUSTER_LEVELS, {});
+    m_tree.clear();
+    m_numIncluded = 0;
+    m_lastIndex = 0;
+    m_streamFilename = filename;
+    m_streamDone = false;
+    m_streamCancel = false;
+    m_streamFailed = false;
+    m_streaming = true;
+    std::cout << "Streaming papers from `" << filename << "`...\n";
+    m_streamThread = std::thread{&PaperLoader::streamFile, this, filename, scale};
+}
+
+// runs on the stream thread, batches are parsed on the worker pool & published in file order
+void PaperLoader::streamFile(const std::string filename, const float scale)
+{
+    const MappedFile file{filename};
+    const char* begin {file.data()};
+    const char* const end {file.data() + file.size()};
+    if (file.isOpen())
+    {
+        // skip utf-8 byte order mark & header row
+        if (file.size() >= 3 && std::string_view{begin, 3} == "\xEF\xBB\xBF")
+        {
+            begin += 3;
+        }
+        begin = nextRow(begin, end);
+    }
+
+    // batches are kept small (so papers show up early), only a few are parsed ahead of the main thread
+    ThreadPool& pool {ThreadPool::shared()};
+    const std::vector<const char*> bounds {splitChunks(begin, end, std::max<std::size_t>(1, static_cast<std::size_t>(end - begin) / MIN_CHUNK_SIZE))};
+    const std::size_t maxInFlight {pool.size() * 2};
+    std::deque<std::future<PaperChunk>> inFlight;
+    std::size_t next{0};
+    while (true)
+    {
+        while (next + 1 < bounds.size() && inFlight.size() < maxInFlight && !m_streamCancel)
+        {
+            inFlight.push_back(pool.submit([this, &bounds, next, scale] {
+                PaperChunk chunk;
+                parseChunk(bounds[next], bounds[next + 1], scale, chunk);
+                return chunk;
+            }));
+            ++next;
+        }
+        if (inFlight.empty())
+        {
+            break;
+        }
+        // tasks read from the mapped file, so they're always waited for (even when cancelled)
+        PaperChunk chunk {inFlight.front().get()};
+        inFlight.pop_front();
+        const std::lock_guard<std::mutex> lock{m_streamMutex};
+        m_streamBatches.push_back(std::move(chunk));
+    }
+    const std::lock_guard<std::mutex> lock{m_streamMutex};
+    m_streamDone = true;
+}
+
+bool PaperLoader::pollBatches()
+{
+    if (!m_streaming)
+    {
+        return false;
+    }
+    std::deque<PaperChunk> batches;
+    bool done{false};
+    {
+        const std::lock_guard<std::mutex> lock{m_streamMutex};
+        batches.swap(m_streamBatches);
+        done = m_streamDone;
+    }
+
+    const std::size_t first {m_papers.size()};
+    for (PaperChunk& batch : batches)
+    {
+        // papers after a batch that doesn't fit are dropped
+        if (!m_streamFailed && !appendChunk(std::move(batch)))
+        {
+            std::cerr << "Error: Too many distinct cluster labels in `" << m_streamFilename << "` (at most 65536 per column), the rest of the file is skipped" << std::endl;
+            m_streamFailed = true;
+            m_streamCancel = true;
+        }
+    }
+    addToClusters(first, m_papers.size());
+
+    if (done)
+    {
+        m_streamThread.join();
+        m_streaming = false;
+        buildClusterMembers();
+        m_tree.build(m_papers, m_members);
+        std::cout << "Loaded csv from `" << m_streamFilename << "`. Rows: " << m_papers.size() << " | " << m_numIncluded << " included | " << m_lastIndex << " LII (" << m_papersSize / 1000000 << " MB)" << '\n';
+        for (int idx{0}; idx < static_cast<int>(m_clusters.size()); ++idx)
+        {
+            printClusterLevel(idx);
+        }
+        const std::string cachePath {PaperCache::getCachePath(m_streamFilename)};
+        if (m_streamFailed)
+        {
+            std::cerr << "Error: Loading `" << m_streamFilename << "` failed, cache isn't written" << std::endl;
+        } else if (m_papers.empty())
+        {
+            std::cerr << "Error: No papers in `" << m_streamFilename << "`, cache isn't written" << std::endl;
+        } else if (!saveCache(cachePath, m_source))
+        {
+            std::cerr << "Error: Failed to write cache to path: `" << cachePath << "`" << std::endl;
+        }
+    }
+    return m_papers.size() > first;
 }
 
 // load papers from csv file
-void PaperLoader::loadFromFile(const std::string& filename, const float scale)
+bool PaperLoader::loadFromFile(const std::string& filename, const float scale)
 {
     // clear previous papers
     m_papers.clear();
-    // wifstream for "wide" character encoding
-    std::wifstream file;
-    // set locale
-    file.imbue(std::locale("en_GB.UTF-8"));
-
-    // handle exceptions
-    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try
-    {
-        file.open(filename);
-        
-        bool firstRow{true};
-        int count{0}; // row counter
-        int included{0}; // num papers included
-        int lastIncluded{0}; // index of last paper included
-        std::wstring line; // the current row
-        do
-        {
-            // read the next line from the file
-            std::getline(file, line);
-            if (firstRow)
+
+    // map the whole file, fields are parsed straight from the raw utf-8 bytes
+    const MappedFile file{filename};
+    if (!file.isOpen())
+    {
+        std::cerr << "Error: Failed to read file from path: `" << filename << "`" << std::endl;
+        return false;
+    }
+
+    const char* begin {file.data()};
+    const char* const end {file.data() + file.size()};
+    // skip utf-8 byte order mark
+    if (file.size() >= 3 && std::string_view{begin, 3} == "\xEF\xBB\xBF")
+    {
+        begin += 3;
+    }
+    // skip header row
+    begin = nextRow(begin, end);
+
+    // split the rows into chunks and parse them on the worker pool
+    ThreadPool& pool {ThreadPool::shared()};
+    const std::size_t numChunks {std::clamp<std::size_t>(static_cast<std::size_t>(end - begin) / MIN_CHUNK_SIZE, 1, pool.size() * 4)};
+    const std::vector<const char*> bounds {splitChunks(begin, end, numChunks)};
+    std::vector<PaperChunk> chunks(bounds.size() - 1);
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(chunks.size());
+    for (std::size_t c{0}; c < chunks.size(); ++c)
+    {
+        tasks.push_back(pool.submit([this, &bounds, &chunks, c, scale] {
+            parseChunk(bounds[c], bounds[c + 1], scale, chunks[c]);
+        }));
+    }
+    for (std::future<void>& task : tasks)
+    {
+        task.get();
+    }
+
+    if (!mergeChunks(chunks))
+    {
+        std::cerr << "Error: Too many distinct cluster labels in `" << filename << "` (at most 65536 per column)" << std::endl;
+        return false;
+    }
+    std::cout << "Loaded csv from `" << filename << "`. Rows: " << m_papers.size() << " | " << m_numIncluded << " included | " << m_lastIndex << " LII | " << chunks.size() << " chunks (" << m_papersSize / 1000000 << " MB)" << '\n';
+    return true;
+}
+
+// merge chunks back in file order (exploration order depends on it) & update stats
+bool PaperLoader::mergeChunks(std::vector<PaperChunk>& chunks)
+{
+    std::size_t total{0};
+    for (const PaperChunk& chunk : chunks)
+    {
+        total += chunk.papers.size();
+    }
+    m_papers.reserve(total);
+    m_numIncluded = 0;
+    m_lastIndex = 0;
+    for (PaperChunk& chunk : chunks)
+    {
+        if (!appendChunk(std::move(chunk)))
+        {
+            m_papers.clear();
+            m_numIncluded = 0;
+            m_lastIndex = 0;
+            m_papersSize = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PaperLoader::appendChunk(PaperChunk&& chunk)
+{
+    const std::size_t first {m_papers.size()};
+    if (!chunk.valid || !m_papers.append(std::move(chunk.papers)))
+    {
+        return false;
+    }
+    if (chunk.lastIncluded > 0)
+    {
+        m_lastIndex = static_cast<unsigned int>(first) + chunk.lastIncluded;
+    }
+    m_numIncluded += chunk.included;
+    // update stats
+    m_papersSize = m_papers.getMemoryUsage();
+    return true;
+}
+
+// parse every row in [begin, end) into chunk
+void PaperLoader::parseChunk(const char* begin, const char* const end, const float scale, PaperChunk& chunk) const
+{
+    // one row per line, so this is a good estimate
+    chunk.papers.reserve(static_cast<std::size_t>(std::count(begin, end, '\n')));
+
+    int count{0}; // row counter
+    Fields fields; // views of the current row's fields
+    std::size_t numFields{0};
+    const char* start {begin}; // start of the current field
+
+    // each row is finished at its newline (or the end of the chunk), returns false if the paper can't be added
+    const auto finishRow = [&]() {
+        // each paper needs exactly 27 fields
+        if (numFields == NUM_PAPER_FIELDS)
+        {
+            // strip carriage return from windows line endings
+            std::string_view& last {fields[NUM_PAPER_FIELDS - 1]};
+            if (!last.empty() && last.back() == '\r')
             {
-                firstRow = false;
-                continue;
+                last.remove_suffix(1);
             }
-            // store the fields
-            std::vector<std::wstring> fields;
-            
-            // load fields from row
-            std::size_t start {0};
-            bool quote{false};
-            for (std::size_t i{0}; i < line.length(); ++i)
+
+            // Create the paper
+            if (!createPaper(fields, chunk.papers, scale))
             {
-                if (line[i] == '"') { // we either started or hit a quote
-                    quote = !quote; // toggle quote
-                }
-                // if we hit a comma and we're not in a quote
-                if (!quote && line[i] == ',')
-                {
-                    // get substring from (start -> i)
-                    fields.push_back(line.substr(start, i - start));
-                    start = i + 1; // update start
-                }
+                chunk.valid = false;
+                return false;
             }
-            // get final field
-            fields.push_back(line.substr(start));
-            
-            // each paper needs exactly 27 fields
-            if (std::size(fields) == 27)
-            {
-                // Create the paper
-                Paper paper;
-                createPaper(fields, paper, scale);
-                m_papers.push_back(paper);
-                ++count; // update row counter
-                std::cout << "Paper No." << count << " | " << included << " included | " << lastIncluded << " LII" << '\r';
-
-                if (paper.included) {
-                    ++included;
-                    lastIncluded = count;
-                }
+            ++count; // update row counter
+
+            if (chunk.papers.isIncluded(chunk.papers.size() - 1)) {
+                ++chunk.included;
+                chunk.lastIncluded = count;
             }
-        } while (file.peek() != EOF); // loop until we reach end of file
+        }
+        numFields = 0;
+        return true;
+    };
 
-        std::cout << std::endl;
-        std::cout << "Loaded csv from `" << filename << "`. Rows: " << count << " (" << std::size(m_papers) * sizeof(Paper) / 1000000 << " MB)" << '\n';
+    // the scanner finds every comma & newline outside of quotes, each one ends a field
+    CsvIndex::Scanner scanner{begin, end};
+    std::vector<const char*> structurals;
+    structurals.reserve(CsvIndex::WINDOW_SIZE / 8);
+    while (scanner.next(structurals))
+    {
+        for (const char* it : structurals)
+        {
+            // get field from (start -> it)
+            if (numFields < NUM_PAPER_FIELDS)
+            {
+                fields[numFields] = std::string_view{start, static_cast<std::size_t>(it - start)};
+            }
+            ++numFields;
+            start = it + 1; // update start
+            if (*it == '\n' && !finishRow())
+            {
+                return;
+            }
+        }
+    }
+    // get final field (last row may not end with a newline)
+    if (start < end || numFields > 0)
+    {
+        if (numFields < NUM_PAPER_FIELDS)
+        {
+            fields[numFields] = std::string_view{start, static_cast<std::size_t>(end - start)};
+        }
+        ++numFields;
+        finishRow();
+    }
+}
 
-        // update stats
-        m_numIncluded = included;
-        m_lastIndex = lastIncluded;
-        m_papersSize = std::size(m_papers) * sizeof(Paper);
-    } catch ([[maybe_unused]] std::ifstream::failure& e)
+// returns numChunks + 1 boundaries, first is begin and last is end
+std::vector<const char*> PaperLoader::splitChunks(const char* const begin, const char* const end, const std::size_t numChunks)
+{
+    std::vector<const char*> bounds{begin};
+    const std::size_t chunkSize {static_cast<std::size_t>(end - begin) / std::max<std::size_t>(1, numChunks)};
+    // quotes can span newlines, so track the quote state from the start of the range
+    bool quote{false};
+    const char* it {begin};
+    for (std::size_t c{1}; c < numChunks; ++c)
     {
-        // clear data and return it (nothing)
-        std::cout << "Error: " << e.what() << '\n';
-        std::cerr << "Error: Failed to read file from path: `" << filename << "`" << std::endl;
-        m_papers.clear(); // clear papers
-        if (file.is_open()) {
-            file.close();
+        const char* target {begin + c * chunkSize};
+        if (target <= it)
+        {
+            continue;
         }
-        return;
+        // an odd number of quotes flips the state
+        quote ^= (std::count(it, target, '"') & 1) != 0;
+        it = target;
+        // find the next newline outside of quotes
+        for (; it < end; ++it)
+        {
+            if (*it == '"')
+            {
+                quote = !quote;
+            } else if (*it == '\n' && !quote)
+            {
+                ++it;
+                break;
+            }
+        }
+        if (it >= end)
+        {
+            break;
+        }
+        bounds.push_back(it);
     }
+    bounds.push_back(end);
+    return bounds;
+}
 
-    file.close();
+const char* PaperLoader::nextRow(const char* it, const char* const end)
+{
+    bool quote{false};
+    for (; it < end; ++it)
+    {
+        if (*it == '"')
+        {
+            quote = !quote;
+        } else if (*it == '\n' && !quote)
+        {
+            return it + 1;
+        }
+    }
+    return end;
 }
 
 // create paper from list of fields
-void PaperLoader::createPaper(const std::vector<std::wstring>& fields, Paper& paper, const float scale) const
-{
-    paper.title = fields[0]; // paper title
-    wstrconv<int>(fields[1], &paper.included); // whether the study is included or not
-    // paper 2D space coordinates
-    wstrconv<double>(fields[2], &paper.pos2Dx);
-    paper.pos2Dx *= scale;
-    wstrconv<double>(fields[3], &paper.pos2Dy);
-    paper.pos2Dy *= scale;
-    // paper 3D space coordinates
-    wstrconv<double>(fields[4], &paper.pos3Dx);
-    paper.pos3Dx *= scale;
-    wstrconv<double>(fields[5], &paper.pos3Dy);
-    paper.pos3Dy *= scale;
-    wstrconv<double>(fields[6], &paper.pos3Dz);
-    paper.pos3Dz *= scale;
-    // cluster coordinates
-    wstrconv<int>(fields[7], &paper.cluster_2_2d); // cluster 2
-    wstrconv<int>(fields[8], &paper.cluster_2_3d);
-    wstrconv<int>(fields[9], &paper.cluster_3_2d); // cluster 3
-    wstrconv<int>(fields[10], &paper.cluster_3_3d);
-    wstrconv<int>(fields[11], &paper.cluster_4_2d); // cluster 4
-    wstrconv<int>(fields[12], &paper.cluster_4_3d);
-    wstrconv<int>(fields[13], &paper.cluster_5_2d); // cluster 5
-    wstrconv<int>(fields[14], &paper.cluster_5_3d);
-    wstrconv<int>(fields[15], &paper.cluster_6_2d); // cluster 6
-    wstrconv<int>(fields[16], &paper.cluster_6_3d);
-    // cluster labels
-    paper.cluster_2_2d_label = fields[17]; // 2D labels
-    paper.cluster_3_2d_label = fields[18];
-    paper.cluster_4_2d_label = fields[19];
-    paper.cluster_5_2d_label = fields[20];
-    paper.cluster_6_2d_label = fields[21];
-    paper.cluster_2_3d_label = fields[22]; // 3D labels
-    paper.cluster_3_3d_label = fields[23];
-    paper.cluster_4_3d_label = fields[24];
-    paper.cluster_5_3d_label = fields[25];
-    paper.cluster_6_3d_label = fields[26];
-}
-
-// scale is double because paper coordinates are double
-void PaperLoader::getVertices(std::vector<float>& vertices, const double scale) {
-    vertices.clear();
+bool PaperLoader::createPaper(const Fields& fields, PaperTable& papers, const float scale) const
+{
+    PaperRow row;
+    row.title = papers.addText(fields[0]); // paper title
     int included{0};
-    int not_included{0};
-    for (std::size_t i{0}; i < std::size(m_papers); ++i)
-    {
-        Paper* paper {&m_papers[i]};
-        paper->counter = i; // update counter
-        vertices.push_back(static_cast<float>(paper->pos3Dx * scale)); // x
-        vertices.push_back(static_cast<float>(paper->pos3Dy * scale)); // y
-        vertices.push_back(static_cast<float>(paper->pos3Dz * scale)); // z
-        vertices.push_back(static_cast<float>(paper->included));
-        vertices.push_back(static_cast<float>(i)); // counter
-        // for debug info
-        if (paper->included)
-            ++included;
-        else
-            not_included++;
+    strconv<int>(fields[1], &included); // whether the study is included or not
+    row.included = included != 0;
+    // paper 2D & 3D space coordinates (parsed as double, stored as float)
+    double pos[5]{};
+    for (std::size_t i{0}; i < 5; ++i)
+    {
+        strconv<double>(fields[2 + i], &pos[i]);
+        pos[i] *= scale;
+    }
+    row.pos2D = {pos[0], pos[1]};
+    row.pos3D = {pos[2], pos[3], pos[4]};
+    // cluster coordinates (2_2d, 2_3d, 3_2d, ... same order as the cluster columns)
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        strconv<std::uint16_t>(fields[7 + c], &row.clusterIDs[c]);
+    }
+    // cluster labels (2D labels for depth 2-6 come first, then the 3D labels), only the dictionary code is stored
+    for (int depth{MIN_CLUSTER_DEPTH}; depth <= MAX_CLUSTER_DEPTH; ++depth)
+    {
+        const std::size_t level {static_cast<std::size_t>(depth - MIN_CLUSTER_DEPTH)};
+        const std::size_t column2D {PaperTable::getClusterColumn(depth, CLUSTER_SPACE_2D)};
+        const std::size_t column3D {PaperTable::getClusterColumn(depth, CLUSTER_SPACE_3D)};
+        if (!papers.internLabel(column2D, fields[17 + level], row.clusterLabels[column2D])
+            || !papers.internLabel(column3D, fields[22 + level], row.clusterLabels[column3D]))
+        {
+            return false;
+        }
     }
+    papers.push(row);
+    return true;
+}
+
+// scale is double because paper coordinates were double (now stored as float)
+void PaperLoader::getInstances(std::vector<PaperInstance>& instances, InstanceBounds& bounds, const double scale) {
+    instances.clear();
+    bounds = {};
+    appendInstances(instances, bounds, scale);
     // get info
-    std::cout << "Loaded " << m_papers.size() << " vertices (" << vertices.size() * sizeof(float) / 1000 << " KB)" << '\n';
-    std::cout << included << " papers included, " << not_included << " papers not included\n";
+    std::cout << "Loaded " << m_papers.size() << " instances (" << instances.size() * sizeof(PaperInstance) / 1000 << " KB)" << '\n';
+    std::cout << m_numIncluded << " papers included, " << m_papers.size() - m_numIncluded << " papers not included\n";
+}
+
+bool PaperLoader::appendInstances(std::vector<PaperInstance>& instances, InstanceBounds& bounds, const double scale)
+{
+    const std::span<const glm::vec3> positions {m_papers.getPositions3D()};
+    const std::size_t first {instances.size()};
+    if (first >= positions.size())
+    {
+        return false;
+    }
+    instances.resize(positions.size());
+    for (std::size_t i{first}; i < positions.size(); ++i)
+    {
+        instances[i].order = static_cast<std::uint32_t>(i);
+    }
+
+    // grow the bounds to fit the new papers (with room to spare, so streamed batches rarely quantize everything again)
+    const glm::vec3 firstPos {glm::dvec3{positions[first]} * scale};
+    glm::vec3 min {first > 0 ? bounds.min : firstPos};
+    glm::vec3 max {first > 0 ? bounds.min + bounds.size : firstPos};
+    for (std::size_t i{first}; i < positions.size(); ++i)
+    {
+        const glm::vec3 pos {glm::dvec3{positions[i]} * scale};
+        min = glm::min(min, pos);
+        max = glm::max(max, pos);
+    }
+    const bool grown {first > 0 && (min != bounds.min || max != bounds.min + bounds.size)};
+    if (grown)
+    {
+        const glm::vec3 margin {(max - min) * INSTANCE_BOUNDS_MARGIN};
+        min -= margin;
+        max += margin;
+    }
+    bounds.min = min;
+    bounds.size = glm::max(max - min, glm::vec3{INSTANCE_MIN_SIZE});
+
+    encodeInstances(instances, grown ? 0 : first, bounds, scale);
     // update stats
-    m_verticesSize = vertices.size() * sizeof(vertices[0]);
+    m_verticesSize = instances.size() * sizeof(PaperInstance);
+    return grown;
+}
+
+void PaperLoader::encodeInstances(const std::span<PaperInstance> instances, const std::size_t first, const InstanceBounds& bounds, const double scale) const
+{
+    const std::span<const glm::vec3> positions {m_papers.getPositions3D()};
+    const glm::dvec3 min {bounds.min};
+    const glm::dvec3 toUnit {65535.0 / glm::dvec3{bounds.size}};
+    for (std::size_t i{first}; i < instances.size(); ++i)
+    {
+        PaperInstance& instance {instances[i]};
+        const std::size_t paper {instance.order};
+        const glm::dvec3 q {glm::clamp(glm::round((glm::dvec3{positions[paper]} * scale - min) * toUnit), 0.0, 65535.0)};
+        instance.pos[0] = static_cast<std::uint16_t>(q.x);
+        instance.pos[1] = static_cast<std::uint16_t>(q.y);
+        instance.pos[2] = static_cast<std::uint16_t>(q.z);
+        instance.flags = m_papers.isIncluded(paper) ? INSTANCE_INCLUDED : 0;
+    }
 }
 
 void PaperLoader::generateClusters()
 {
     std::cout << "Generating clusters...\n";
-    for (int i{0}; i < 5; ++i)
+    for (ClusterLevel& level : m_clusters)
     {
-        generateClusterLevel(i);
+        level.clear();
+    }
+    addToClusters(0, m_papers.size());
+    buildClusterMembers();
+    m_tree.build(m_papers, m_members);
+    for (int i{0}; i < static_cast<int>(m_clusters.size()); ++i)
+    {
+        printClusterLevel(i);
     }
     std::cout << "-----------------------\n";
     std::cout << "Generated clusters!\n";
@@ -181,105 +558,509 @@ void PaperLoader::generateClusters()
 // generates clusters for a given level from papers
 void PaperLoader::generateClusterLevel(const int idx)
 {
-    for (const Paper& paper : m_papers)
+    m_clusters[idx].clear();
+    addToClusterLevel(idx, 0, m_papers.size());
+    updateCentroids(idx);
+    printClusterLevel(idx);
+}
+
+// ranges with at least this many papers build their levels on the worker pool
+constexpr std::size_t MIN_PARALLEL_CLUSTER_PAPERS {1 << 16};
+// papers per block of the single pass (positions of a block stay in cache while every level adds it)
+constexpr std::size_t CLUSTER_BLOCK_SIZE {1 << 12};
+
+void PaperLoader::addToClusters(const std::size_t first, const std::size_t last)
+{
+    if (first >= last)
+    {
+        return;
+    }
+    const int numLevels {static_cast<int>(m_clusters.size())};
+    ThreadPool& pool {ThreadPool::shared()};
+    if (pool.size() > 1 && last - first >= MIN_PARALLEL_CLUSTER_PAPERS)
     {
-        int clusterID {getClusterID(paper, idx + 2)};
-        // if cluster doesn't exist yet create it
-        if (!m_clusters[idx].contains(clusterID))
+        // levels don't share any state, so each one is built by its own worker
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(m_clusters.size());
+        for (int idx{0}; idx < numLevels; ++idx)
         {
-            // create new cluster
-            m_clusters[idx].insert(std::pair{clusterID, Cluster{}});
-            // set correct label
-            m_clusters[idx][getClusterID(paper, idx + 2)].label = getClusterLabel(paper, idx + 2);
+            tasks.push_back(pool.submit([this, idx, first, last] { addToClusterLevel(idx, first, last); }));
         }
-        // add another paper to cluster
-        ++m_clusters[idx][clusterID].num_papers;
-        // add paper vertices
-        m_clusters[idx][clusterID].vertices.push_back({paper.pos3Dx, paper.pos3Dy, paper.pos3Dz});
+        for (std::future<void>& task : tasks)
+        {
+            task.get();
+        }
+    } else
+    {
+        for (std::size_t block{first}; block < last; block += CLUSTER_BLOCK_SIZE)
+        {
+            const std::size_t blockEnd {std::min(last, block + CLUSTER_BLOCK_SIZE)};
+            for (int idx{0}; idx < numLevels; ++idx)
+            {
+                addToClusterLevel(idx, block, blockEnd);
+            }
+        }
+    }
+    for (int idx{0}; idx < numLevels; ++idx)
+    {
+        updateCentroids(idx);
     }
+}
+
+void PaperLoader::addToClusterLevel(const int idx, const std::size_t first, const std::size_t last)
+{
+    if (first >= last)
+    {
+        return;
+    }
+    // only the columns we need
+    const int depth {idx + MIN_CLUSTER_DEPTH};
+    const std::span<const std::uint16_t> clusterIDs {m_papers.getClusterIDs(depth)};
+    const std::span<const std::uint16_t> labelCodes {m_papers.getLabelCodes(depth)};
+    const LabelDictionary& labels {m_papers.getLabelDictionary(depth)};
+    const std::span<const glm::vec3> positions {m_papers.getPositions3D()};
+
+    // clusters are indexed by id, so make room for the largest one up front
+    ClusterLevel& level {m_clusters[idx]};
+    const std::uint16_t maxID {*std::max_element(clusterIDs.begin() + static_cast<std::ptrdiff_t>(first), clusterIDs.begin() + static_cast<std::ptrdiff_t>(last))};
+    if (maxID >= level.size())
+    {
+        level.resize(static_cast<std::size_t>(maxID) + 1);
+    }
+    for (std::size_t i{first}; i < last; ++i)
+    {
+        Cluster& cluster {level[clusterIDs[i]]};
+        const glm::vec3& pos {positions[i]};
+        if (cluster.num_papers == 0)
+        {
+            // first paper of the cluster, set label & bounds
+            cluster.label = labels.getLabel(labelCodes[i]);
+            cluster.min = pos;
+            cluster.max = pos;
+        }
+        ++cluster.num_papers;
+        cluster.min = glm::min(cluster.min, pos);
+        cluster.max = glm::max(cluster.max, pos);
+        cluster.posSum += glm::dvec3{pos};
+    }
+}
+
+void PaperLoader::updateCentroids(const int idx)
+{
+    for (Cluster& cluster : m_clusters[idx])
+    {
+        if (cluster.num_papers > 0)
+        {
+            cluster.pos = glm::vec3{cluster.posSum / static_cast<double>(cluster.num_papers)};
+        }
+    }
+}
+
+bool PaperLoader::buildClusterMembers()
+{
+    const int numLevels {static_cast<int>(m_clusters.size())};
+    ThreadPool& pool {ThreadPool::shared()};
+    bool valid{true};
+    if (pool.size() > 1 && m_papers.size() >= MIN_PARALLEL_CLUSTER_PAPERS)
+    {
+        std::vector<std::future<bool>> tasks;
+        tasks.reserve(m_clusters.size());
+        for (int idx{0}; idx < numLevels; ++idx)
+        {
+            tasks.push_back(pool.submit([this, idx] { return buildClusterMembers(idx); }));
+        }
+        for (std::future<bool>& task : tasks)
+        {
+            valid = task.get() && valid;
+        }
+        return valid;
+    }
+    for (int idx{0}; idx < numLevels; ++idx)
+    {
+        valid = buildClusterMembers(idx) && valid;
+    }
+    return valid;
+}
+
+bool PaperLoader::buildClusterMembers(const int idx)
+{
+    return buildMembers(m_papers.getClusterIDs(idx + MIN_CLUSTER_DEPTH), m_clusters[idx].size(), m_members[idx]);
+}
+
+// counting sort of the paper indices by cluster id (stable, so each cluster's papers stay in file order)
+bool PaperLoader::buildMembers(const std::span<const std::uint16_t> clusterIDs, const std::size_t numClusters, ClusterMembers& members) const
+{
+    members.offsets.assign(numClusters + 1, 0);
+    for (const std::uint16_t id : clusterIDs)
+    {
+        if (id >= numClusters)
+        {
+            members = {};
+            return false;
+        }
+        ++members.offsets[id + 1];
+    }
+    for (std::size_t id{0}; id < numClusters; ++id)
+    {
+        members.offsets[id + 1] += members.offsets[id];
+    }
+    members.indices.resize(clusterIDs.size());
+    std::vector<std::uint32_t> next(members.offsets.begin(), members.offsets.end() - 1);
+    for (std::size_t i{0}; i < clusterIDs.size(); ++i)
+    {
+        members.indices[next[clusterIDs[i]]++] = static_cast<std::uint32_t>(i);
+    }
+    members.firstPaper.assign(numClusters, ClusterMembers::NO_PAPER);
+    members.lastPaper.assign(numClusters, ClusterMembers::NO_PAPER);
+    for (std::size_t id{0}; id < numClusters; ++id)
+    {
+        if (members.offsets[id + 1] > members.offsets[id])
+        {
+            members.firstPaper[id] = members.indices[members.offsets[id]];
+            members.lastPaper[id] = members.indices[members.offsets[id + 1] - 1];
+        }
+    }
+    members.includedPrefix.resize(members.indices.size() + 1);
+    members.includedPrefix[0] = 0;
+    for (std::size_t i{0}; i < members.indices.size(); ++i)
+    {
+        members.includedPrefix[i + 1] = members.includedPrefix[i] + static_cast<std::uint32_t>(m_papers.isIncluded(members.indices[i]));
+    }
+    return true;
+}
+
+void PaperLoader::printClusterLevel(const int idx) const
+{
     // print clusters at level idx + 2
     std::cout << "--- Level " << idx + 2 << " Clusters ---\n";
-    // const int since keys cannot be changed
-    for (std::pair<const int, Cluster>& cluster : m_clusters[idx])
+    for (std::size_t id{0}; id < m_clusters[idx].size(); ++id)
     {
-        // calculate cluster centroid
-        cluster.second.pos = getAvgPos(cluster.second.vertices);
-        std::wcout << "\tCluster No." << cluster.first << " (" << cluster.second.num_papers << " papers, under `" << cluster.second.label << "`)\n";
-        std::cout << "\tCluster centroid: " << cluster.second.pos.x << " " << cluster.second.pos.y << " " << cluster.second.pos.z << "\n";
+        const Cluster& cluster {m_clusters[idx][id]};
+        if (cluster.num_papers == 0)
+        {
+            continue;
+        }
+        std::cout << "\tCluster No." << id << " (" << cluster.num_papers << " papers, under `" << cluster.label << "`)\n";
+        std::cout << "\tCluster centroid: " << cluster.pos.x << " " << cluster.pos.y << " " << cluster.pos.z << "\n";
     }
 }
 
-glm::vec3 PaperLoader::getAvgPos(const std::vector<glm::vec3>& papers) const
+KMeans::Result PaperLoader::runKMeans(const int k, const ClusterSpace space) const
 {
-    glm::vec3 avg{0.0f};
-    for (const glm::vec3& pos : papers)
+    KMeans::Settings settings{};
+    settings.k = k;
+    if (space == CLUSTER_SPACE_2D)
     {
-        avg += pos;
+        return KMeans::run(m_papers.getPositions2D(), settings);
     }
-    // convert to int from unsigned int first to avoid *weird* errors
-    avg /= static_cast<float>(papers.size());
-    return avg;
+    return KMeans::run(m_papers.getPositions3D(), settings);
 }
 
-// return cluster id for paper at given depth (2-6) default depth is 2
-int PaperLoader::getClusterID(const Paper& paper, int depth) const
+void PaperLoader::setKMeansClusters(KMeans::Result&& result)
 {
-    depth = std::max(2, std::min(6, depth));
-    switch (depth)
+    clearKMeansClusters();
+    if (result.assignments.size() != m_papers.size())
+    {
+        return;
+    }
+    m_kmeansIDs = std::move(result.assignments);
+
+    // cluster stats come from the 3D positions, like the precomputed levels (even if the 2D ones were clustered)
+    const std::span<const glm::vec3> positions {m_papers.getPositions3D()};
+    m_kmeansClusters.resize(result.centroids.size());
+    for (std::size_t i{0}; i < m_kmeansIDs.size(); ++i)
     {
-        case 2:
-            return paper.cluster_2_3d;
-        case 3:
-            return paper.cluster_3_3d;
-        case 4:
-            return paper.cluster_4_3d;
-        case 5:
-            return paper.cluster_5_3d;
-        case 6:
-            return paper.cluster_6_3d;
-        default:
-            return paper.cluster_2_3d;
+        Cluster& cluster {m_kmeansClusters[m_kmeansIDs[i]]};
+        const glm::vec3& pos {positions[i]};
+        if (cluster.num_papers == 0)
+        {
+            cluster.min = pos;
+            cluster.max = pos;
+        }
+        ++cluster.num_papers;
+        cluster.min = glm::min(cluster.min, pos);
+        cluster.max = glm::max(cluster.max, pos);
+        cluster.posSum += glm::dvec3{pos};
     }
+    for (Cluster& cluster : m_kmeansClusters)
+    {
+        if (cluster.num_papers > 0)
+        {
+            cluster.pos = glm::vec3{cluster.posSum / static_cast<double>(cluster.num_papers)};
+        }
+    }
+    buildMembers(m_kmeansIDs, m_kmeansClusters.size(), m_kmeansMembers);
+
+    // k-means clusters have no labels of their own, so each is named after the finest label most of its papers share
+    const std::span<const std::uint16_t> labelCodes {m_papers.getLabelCodes(MAX_CLUSTER_DEPTH)};
+    const LabelDictionary& labels {m_papers.getLabelDictionary(MAX_CLUSTER_DEPTH)};
+    std::vector<std::uint32_t> counts;
+    for (std::size_t id{0}; id < m_kmeansClusters.size(); ++id)
+    {
+        counts.assign(labels.size(), 0);
+        for (std::uint32_t paper : getClusterMembers(KMEANS_CLUSTER_DEPTH, static_cast<int>(id)))
+        {
+            ++counts[labelCodes[paper]];
+        }
+        if (m_kmeansClusters[id].num_papers > 0)
+        {
+            const auto mostCommon {std::max_element(counts.begin(), counts.end())};
+            m_kmeansClusters[id].label = labels.getLabel(static_cast<std::uint16_t>(mostCommon - counts.begin()));
+        }
+    }
+
+    std::cout << "k-means: " << m_kmeansClusters.size() << " clusters, " << result.iterations << " iterations"
+              << (result.converged ? "" : " (not converged)") << " | "
+              << 100.0 * static_cast<double>(result.numDistances) / (static_cast<double>(m_kmeansIDs.size()) * static_cast<double>(m_kmeansClusters.size()) * std::max(1, result.iterations))
+              << "% of the distances computed" << '\n';
+}
+
+bool PaperLoader::generateKMeansClusters(const int k, const ClusterSpace space)
+{
+    if (m_streaming || m_papers.empty())
+    {
+        return false;
+    }
+    const auto start {std::chrono::steady_clock::now()};
+    setKMeansClusters(runKMeans(k, space));
+    const std::chrono::duration<double, std::milli> time {std::chrono::steady_clock::now() - start};
+    std::cout << "Generated k-means clusters (" << time.count() << " ms)" << '\n';
+    return true;
 }
 
-// return cluster label for paper at given depth (2-6) default depth is 2
-std::wstring PaperLoader::getClusterLabel(const Paper& paper, int depth) const
+void PaperLoader::clearKMeansClusters()
 {
-    depth = std::max(2, std::min(6, depth));
-    switch (depth)
+    m_kmeansIDs = {};
+    m_kmeansClusters = {};
+    m_kmeansMembers = {};
+}
+
+// return cluster id for paper at given depth (2-6), -1 if the paper hasn't been loaded (yet)
+int PaperLoader::getClusterID(const std::size_t paper, const int depth) const
+{
+    if (depth == KMEANS_CLUSTER_DEPTH)
     {
-        case 2:
-            return paper.cluster_2_3d_label;
-        case 3:
-            return paper.cluster_3_3d_label;
-        case 4:
-            return paper.cluster_4_3d_label;
-        case 5:
-            return paper.cluster_5_3d_label;
-        case 6:
-            return paper.cluster_6_3d_label;
-        default:
-            return paper.cluster_2_3d_label;
+        return paper < m_kmeansIDs.size() ? m_kmeansIDs[paper] : -1;
     }
+    return paper < m_papers.size() ? m_papers.getClusterID(paper, depth) : -1;
 }
 
-Cluster* PaperLoader::getCluster(int id, int depth)
+// return cluster label for paper at given depth (2-6), empty if the paper hasn't been loaded (yet)
+std::string_view PaperLoader::getClusterLabel(const std::size_t paper, const int depth) const
 {
-    depth = std::max(2, std::min(6, depth));
+    if (depth == KMEANS_CLUSTER_DEPTH)
+    {
+        return paper < m_kmeansIDs.size() ? std::string_view{m_kmeansClusters[m_kmeansIDs[paper]].label} : std::string_view{};
+    }
+    return paper < m_papers.size() ? m_papers.getClusterLabel(paper, depth) : std::string_view{};
+}
+
+// return cluster with given id at depth (2-6), nullptr if there's no such cluster (yet)
+Cluster* PaperLoader::getCluster(const int id, int depth)
+{
+    depth = std::max(2, std::min(KMEANS_CLUSTER_DEPTH, depth));
     // avoid copying large cluster
-    std::map<int, Cluster>* cluster {&m_clusters[depth - 2]};
-    return &(*cluster)[id];
+    ClusterLevel& level {depth == KMEANS_CLUSTER_DEPTH ? m_kmeansClusters : m_clusters[depth - 2]};
+    return id >= 0 && static_cast<std::size_t>(id) < level.size() ? &level[id] : nullptr;
 }
 
-// return map of clusters for given depth (2-6)
-std::map<int, Cluster> PaperLoader::getClusters(const int depth) const
+// return clusters for given depth (2-6, or the k-means depth), indexed by cluster id
+std::span<const Cluster> PaperLoader::getClusters(const int depth) const
 {
+    if (depth == KMEANS_CLUSTER_DEPTH)
+    {
+        return m_kmeansClusters;
+    }
     const std::size_t index {static_cast<std::size_t>(std::max(2, std::min(6, depth)))};
     return m_clusters[index - 2];
 }
 
-const Paper& PaperLoader::getPaper(float progress) const
+// return papers of cluster id at given depth (2-6)
+std::span<const std::uint32_t> PaperLoader::getClusterMembers(const int depth, const int id) const
+{
+    const ClusterMembers& members {getClusterMembersFull(depth)};
+    if (id < 0 || static_cast<std::size_t>(id) + 1 >= members.offsets.size())
+    {
+        return {};
+    }
+    return std::span<const std::uint32_t>{members.indices}.subspan(members.offsets[id], members.offsets[id + 1] - members.offsets[id]);
+}
+
+const ClusterMembers& PaperLoader::getClusterMembersFull(const int depth) const
+{
+    if (depth == KMEANS_CLUSTER_DEPTH)
+    {
+        return m_kmeansMembers;
+    }
+    return m_members[static_cast<std::size_t>(std::max(2, std::min(6, depth)) - 2)];
+}
+
+// return cluster ids of all papers at given depth (2-6, or the k-means depth)
+std::span<const std::uint16_t> PaperLoader::getClusterIDs(const int depth) const
+{
+    if (depth == KMEANS_CLUSTER_DEPTH)
+    {
+        return m_kmeansIDs;
+    }
+    return m_papers.getClusterIDs(std::max(2, std::min(6, depth)));
+}
+
+void PaperLoader::getExploredCounts(const int depth, const std::size_t numExplored, std::vector<ExploredCount>& counts) const
+{
+    const ClusterMembers& members {getClusterMembersFull(depth)};
+    if (members.offsets.empty() || members.includedPrefix.size() != members.indices.size() + 1)
+    {
+        counts.clear();
+        return;
+    }
+    const std::size_t numClusters {members.offsets.size() - 1};
+    counts.resize(numClusters);
+    for (std::size_t id{0}; id < numClusters; ++id)
+    {
+        // members are sorted, so the explored ones come first
+        const auto first {members.indices.begin() + members.offsets[id]};
+        const auto last {members.indices.begin() + members.offsets[id + 1]};
+        const std::size_t explored {static_cast<std::size_t>(std::lower_bound(first, last, numExplored) - members.indices.begin())};
+        counts[id].numPapers = static_cast<int>(explored - members.offsets[id]);
+        counts[id].numIncluded = static_cast<int>(members.includedPrefix[explored] - members.includedPrefix[members.offsets[id]]);
+    }
+}
+
+namespace
 {
-    progress = std::max(0.f, std::min(progress, static_cast<float>(getNumPapers())));
-    return m_papers[std::max(static_cast<unsigned int>(0), std::min(static_cast<unsigned int>(m_papers.size() - 1), static_cast<unsigned int>(progress)))];
-}
\ No newline at end of file
+    // cluster as stored in the cache, the label points into the level's text array
+    struct CachedCluster
+    {
+        std::int32_t id;
+        std::int32_t numPapers;
+        glm::vec3 pos;
+        glm::vec3 min;
+        glm::vec3 max;
+        // explicit, so the bytes before the 8 byte aligned label are written as zeros
+        std::uint32_t padding{0};
+        TextHandle label;
+    };
+    static_assert(sizeof(CachedCluster) == 64);
+}
+
+bool PaperLoader::saveCache(const std::string& path, const PaperCache::SourceInfo& source) const
+{
+    // an empty cache would be valid & hide the source file from later runs
+    if (m_papers.empty())
+    {
+        return false;
+    }
+    PaperCache::Writer writer{path};
+    writer.write(PaperCache::makeHeader(source));
+    writer.write<std::uint32_t>(m_numIncluded);
+    writer.write<std::uint32_t>(m_lastIndex);
+    m_papers.save(writer);
+    // cluster tables, the members aren't stored since they're rebuilt from the cluster id columns
+    for (const ClusterLevel& level : m_clusters)
+    {
+        std::vector<CachedCluster> clusters;
+        std::string labels;
+        for (std::size_t id{0}; id < level.size(); ++id)
+        {
+            const Cluster& cluster {level[id]};
+            if (cluster.num_papers == 0)
+            {
+                continue;
+            }
+            const TextHandle label {labels.size(), static_cast<std::uint32_t>(cluster.label.size())};
+            clusters.push_back({static_cast<std::int32_t>(id), cluster.num_papers, cluster.pos, cluster.min, cluster.max, 0, label});
+            labels += cluster.label;
+        }
+        writer.writeArray(std::span<const CachedCluster>{clusters});
+        writer.writeString(labels);
+    }
+    return writer.finish();
+}
+
+bool PaperLoader::loadCache(const std::string& path, const PaperCache::SourceInfo& source)
+{
+    MappedFile file{path};
+    if (!file.isOpen())
+    {
+        return false;
+    }
+    PaperCache::Reader reader{file.view()};
+    PaperCache::Header header;
+    std::uint32_t numIncluded{0};
+    std::uint32_t lastIndex{0};
+    if (!reader.read(header) || !PaperCache::isValid(header, source) || !reader.read(numIncluded) || !reader.read(lastIndex))
+    {
+        return false;
+    }
+    if (!m_papers.load(reader))
+    {
+        return false;
+    }
+
+    bool valid{true};
+    for (std::size_t idx{0}; valid && idx < m_clusters.size(); ++idx)
+    {
+        ClusterLevel& level {m_clusters[idx]};
+        level.clear();
+        std::span<const CachedCluster> clusters;
+        std::string_view labels;
+        valid = reader.readArray(clusters) && reader.readString(labels);
+        for (std::size_t c{0}; valid && c < clusters.size(); ++c)
+        {
+            const CachedCluster& cached {clusters[c]};
+            // ids are cluster id columns (uint16)
+            valid = cached.id >= 0 && cached.id <= UINT16_MAX && cached.numPapers > 0
+                    && cached.label.offset <= labels.size() && cached.label.length <= labels.size() - cached.label.offset;
+            if (valid)
+            {
+                if (static_cast<std::size_t>(cached.id) >= level.size())
+                {
+                    level.resize(static_cast<std::size_t>(cached.id) + 1);
+                }
+                Cluster& cluster {level[static_cast<std::size_t>(cached.id)]};
+                cluster.num_papers = cached.numPapers;
+                cluster.pos = cached.pos;
+                cluster.min = cached.min;
+                cluster.max = cached.max;
+                cluster.posSum = glm::dvec3{cached.pos} * static_cast<double>(cached.numPapers);
+                cluster.label = labels.substr(cached.label.offset, cached.label.length);
+            }
+        }
+        // rebuild members from the cluster id column, every paper's cluster has to be in the cache with the right count
+        valid = valid && buildClusterMembers(static_cast<int>(idx));
+        const ClusterMembers& members {m_members[idx]};
+        for (std::size_t id{0}; valid && id < level.size(); ++id)
+        {
+            valid = members.offsets[id + 1] - members.offsets[id] == static_cast<std::uint32_t>(level[id].num_papers);
+        }
+    }
+    if (!valid)
+    {
+        m_papers.clear();
+        for (ClusterLevel& level : m_clusters)
+        {
+            level.clear();
+        }
+        m_members.assign(NUM_CLUSTER_LEVELS, {});
+        m_tree.clear();
+        return false;
+    }
+
+    // columns view the mapped file, so the table keeps it open
+    m_papers.attach(std::move(file));
+    m_tree.build(m_papers, m_members);
+    m_numIncluded = numIncluded;
+    m_lastIndex = lastIndex;
+    m_papersSize = m_papers.getMemoryUsage();
+    return true;
+}
+
+std::size_t PaperLoader::getPaperIndex(float progress) const
+{
+    if (m_papers.empty())
+    {
+        return 0;
+    }
+    progress = std::max(0.f, std::min(progress, static_cast<float>(getNumPapers() - 1)));
+    return static_cast<std::size_t>(progress);
+}
@@ -5,117 +5,271 @@
 #ifndef PAPER_LOADER_H
 #define PAPER_LOADER_H
 
-#include <sstream>
 #include <vector>
+#include <span>
 #include <string>
-#include <locale>
+#include <string_view>
+#include <array>
+#include <charconv>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
 
 #include <glm/glm.hpp>
 
-struct Paper
+#include "paper_table.h"
+#include "paper_cache.h"
+#include "kmeans.h"
+#include "cluster_tree.h"
+
+// papers parsed from one chunk of the csv file
+struct PaperChunk
+{
+    PaperTable papers{};
+    int included{0}; // num papers included in chunk
+    int lastIncluded{0}; // row number (1-based, within chunk) of last paper included
+    bool valid{true}; // false if parsing stopped because a label column has more distinct labels than 16 bit codes
+};
+
+// paper instance as uploaded to the gpu (12 bytes), the position is quantized to 16 bits per axis within the
+// instance bounds & the order index is exact for any number of papers
+struct PaperInstance
 {
-    // paper title
-    std::wstring title;
-    // whether the study is included or not
-    int included;
-    // 2d position
-    double pos2Dx;
-    double pos2Dy;
-    // 3d position
-    double pos3Dx;
-    double pos3Dy;
-    double pos3Dz;
-    int cluster_2_2d;
-    int cluster_2_3d;
-    int cluster_3_2d;
-    int cluster_3_3d;
-    int cluster_4_2d;
-    int cluster_4_3d;
-    int cluster_5_2d;
-    int cluster_5_3d;
-    int cluster_6_2d;
-    int cluster_6_3d;
-    std::wstring cluster_2_2d_label;
-    std::wstring cluster_3_2d_label;
-    std::wstring cluster_4_2d_label;
-    std::wstring cluster_5_2d_label;
-    std::wstring cluster_6_2d_label;
-    std::wstring cluster_2_3d_label;
-    std::wstring cluster_3_3d_label;
-    std::wstring cluster_4_3d_label;
-    std::wstring cluster_5_3d_label;
-    std::wstring cluster_6_3d_label;
-    int counter;
+    std::uint16_t pos[3];
+    std::uint16_t flags;
+    // index of the paper in exploration order
+    std::uint32_t order;
+};
+static_assert(sizeof(PaperInstance) == 12);
+
+// PaperInstance::flags bits
+constexpr std::uint16_t INSTANCE_INCLUDED {1 << 0};
+
+// box the instance positions are quantized within, position = min + pos / 65535 * size
+struct InstanceBounds
+{
+    glm::vec3 min{0.0f};
+    glm::vec3 size{1.0f};
 };
 
 struct Cluster
 {
     int num_papers{0};
-    std::wstring label;
-    std::vector<glm::vec3> vertices;
-    glm::vec3 pos;
+    std::string label; // utf-8
+    glm::vec3 pos{0.0f};
+    // bounding box of the papers
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+    // sum of paper positions (in double, so centroids stay accurate with millions of papers) & updated as papers are added
+    glm::dvec3 posSum{0.0};
+};
+
+// clusters of one depth, indexed by cluster id (ids without papers are empty, num_papers == 0)
+using ClusterLevel = std::vector<Cluster>;
+
+// papers of each cluster of one depth (compressed sparse rows), the papers of cluster id are
+// indices[offsets[id], offsets[id + 1]) in ascending order
+struct ClusterMembers
+{
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> indices;
+    // included papers among indices[0, i), so the included papers of any range of a cluster are counted in O(1)
+    std::vector<std::uint32_t> includedPrefix;
+    // first & last paper of each cluster (in animation order, NO_PAPER if it's empty), so whether a cluster is
+    // passed (or fully explored) at any progress is a single comparison
+    std::vector<std::uint32_t> firstPaper;
+    std::vector<std::uint32_t> lastPaper;
+
+    static constexpr std::uint32_t NO_PAPER {0xFFFFFFFF};
 };
 
+// papers of a cluster the animation has passed
+struct ExploredCount
+{
+    int numPapers{0};
+    int numIncluded{0};
+};
+
+// depth of the clusters computed in the app with k-means (after the precomputed depths)
+constexpr int KMEANS_CLUSTER_DEPTH {MAX_CLUSTER_DEPTH + 1};
+
+// number of fields (columns) in each row of the csv file
+constexpr std::size_t NUM_PAPER_FIELDS {27};
+
 class PaperLoader
 {
 public:
+    using Fields = std::array<std::string_view, NUM_PAPER_FIELDS>;
+
     PaperLoader();
-    ~PaperLoader() = default;
+    // stops streaming (if still running)
+    ~PaperLoader();
 
-    // load papers data from csv file
-    void loadFromFile(const std::string& filename, float scale);
+    PaperLoader(const PaperLoader&) = delete;
+    PaperLoader& operator=(const PaperLoader&) = delete;
 
-    // create paper from list of fields
-    void createPaper(const std::vector<std::wstring>& fields, Paper& paper, float scale) const;
+    // load papers & clusters from the snapshot cache next to the csv file, if it's missing or stale
+    // the csv (or parquet) file is parsed, clusters are generated and the cache is rebuilt
+    void load(const std::string& filename, float scale);
 
-    // convert from std::wstring to template type
+    // load papers data from csv file, chunks of the file are parsed in parallel, returns false if it can't be read
+    bool loadFromFile(const std::string& filename, float scale);
+#ifdef PV_WITH_PARQUET
+    // load papers data from parquet file (same columns as the csv file), row groups are decoded in parallel,
+    // returns false if it can't be read or decoded
+    bool loadFromParquet(const std::string& filename, float scale);
+#endif
+    // move parsed chunks (in order) into the paper table & update stats, returns false (with no papers) if a chunk
+    // isn't valid or the merged labels don't fit in 16 bit codes
+    bool mergeChunks(std::vector<PaperChunk>& chunks);
+    // move chunk to the end of the paper table & update stats, returns false (and adds nothing) like mergeChunks
+    bool appendChunk(PaperChunk&& chunk);
+
+    // ---- streaming load ---- //
+    // like load(), but the csv file is parsed in batches on a background thread, so rendering can start right away
+    // (batches are added to the papers by pollBatches(), if the cache is up to date it's loaded straight away)
+    void startStreaming(const std::string& filename, float scale);
+    // add batches parsed so far (in file order) to the papers & clusters, returns true if any papers were added
+    // once the last batch is added the clusters are printed and the cache is saved
+    bool pollBatches();
+    // true until the last batch has been added
+    [[nodiscard]] bool isStreaming() const {return m_streaming;}
+
+    // map snapshot cache, papers are used in place, returns false if it's missing or wasn't built from source
+    bool loadCache(const std::string& path, const PaperCache::SourceInfo& source);
+    // write papers, labels & clusters to snapshot cache, returns false if there are no papers or it can't be written
+    bool saveCache(const std::string& path, const PaperCache::SourceInfo& source) const;
+
+    // parse all rows in [begin, end) (begin must be at the start of a row)
+    void parseChunk(const char* begin, const char* end, float scale, PaperChunk& chunk) const;
+    // split [begin, end) into roughly equal chunks that start at row boundaries (outside quotes)
+    static std::vector<const char*> splitChunks(const char* begin, const char* end, std::size_t numChunks);
+    // skip to the start of the next row
+    static const char* nextRow(const char* it, const char* end);
+
+    // create paper from list of fields (views into the raw utf-8 file buffer) and add it to papers,
+    // returns false if a label doesn't fit in its dictionary
+    bool createPaper(const Fields& fields, PaperTable& papers, float scale) const;
+
+    // parse number from utf-8 field, x is left untouched if the field isn't a number
     template <typename T>
-    static void wstrconv(const std::wstring& wstr, T* x)
+    static void strconv(std::string_view str, T* x)
     {
-        std::wstringstream wss{wstr};
-        wss >> *x;
+        // skip leading whitespace like operator>> does
+        while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+        {
+            str.remove_prefix(1);
+        }
+        std::from_chars(str.data(), str.data() + str.size(), *x);
     }
 
-    // gets list of 3D vertices from paper list
-    void getVertices(std::vector<float>& vertices, double scale = 1.0f);
+    // gets list of paper instances, bounds are fit to the papers
+    void getInstances(std::vector<PaperInstance>& instances, InstanceBounds& bounds, double scale = 1.0f);
+    // append instances of papers [instances.size(), numPapers) in paper order, if any of them is outside the bounds they're grown
+    // & all instances are quantized again (returns true, so everything has to be uploaded again)
+    bool appendInstances(std::vector<PaperInstance>& instances, InstanceBounds& bounds, double scale = 1.0f);
+    // quantize instances [first, instances.size()) within bounds, each instance is the paper of its order index
+    // (so instances can be reordered, e.g. spatially)
+    void encodeInstances(std::span<PaperInstance> instances, std::size_t first, const InstanceBounds& bounds, double scale) const;
 
     // loads cluster levels from papers
     void generateClusters();
     // generate single cluster level
     void generateClusterLevel(int idx);
+    // add papers [first, last) to the clusters of all levels & update their centroids
+    // (levels are built in parallel for large ranges, small ones in a single pass over the papers)
+    void addToClusters(std::size_t first, std::size_t last);
+    // add papers [first, last) to the clusters of level idx (counts, bounds, position sums & labels)
+    void addToClusterLevel(int idx, std::size_t first, std::size_t last);
+    // set centroids of level idx from the position sums
+    void updateCentroids(int idx);
+    // sort the papers of all levels by cluster (once all papers are added), returns false if a paper's cluster is missing
+    bool buildClusterMembers();
+    bool buildClusterMembers(int idx);
+    // counting sort of the indices by cluster id (& included prefix counts), returns false if an id is >= numClusters
+    bool buildMembers(std::span<const std::uint16_t> clusterIDs, std::size_t numClusters, ClusterMembers& members) const;
+    // print clusters of level idx
+    void printClusterLevel(int idx) const;
 
-    [[nodiscard]] glm::vec3 getAvgPos(const std::vector<glm::vec3>& papers) const;
+    // ---- k-means clusters (KMEANS_CLUSTER_DEPTH) ---- //
+    // cluster all papers into k clusters by their 3D or 2D positions (the papers must be fully loaded),
+    // thread safe as long as the papers aren't changed, the result is applied with setKMeansClusters()
+    [[nodiscard]] KMeans::Result runKMeans(int k, ClusterSpace space = CLUSTER_SPACE_3D) const;
+    // replace the k-means clusters with result, clusters get the most common depth 6 label of their papers
+    void setKMeansClusters(KMeans::Result&& result);
+    // run k-means & apply the result, returns false if the papers aren't loaded
+    bool generateKMeansClusters(int k, ClusterSpace space = CLUSTER_SPACE_3D);
+    // false until k-means clusters have been generated
+    [[nodiscard]] bool hasKMeansClusters() const {return !m_kmeansClusters.empty();}
 
     // get cluster info from papers at a specific depth
-    [[nodiscard]] int getClusterID(const Paper& paper, int depth) const;
-    [[nodiscard]] std::wstring getClusterLabel(const Paper& paper, int depth) const;
+    [[nodiscard]] int getClusterID(std::size_t paper, int depth) const;
+    [[nodiscard]] std::string_view getClusterLabel(std::size_t paper, int depth) const;
 
     Cluster* getCluster(int id, int depth);
 
     // papers getter
-    [[nodiscard]] const std::vector<Paper>& getPapers() const {return m_papers;}
-    [[nodiscard]] const Paper& getPaper(float progress) const;  // TODO: Add clamp to account for negative animation_speed
+    [[nodiscard]] const PaperTable& getPapers() const {return m_papers;}
+    // index of the paper the animation is at
+    [[nodiscard]] std::size_t getPaperIndex(float progress) const;
     // clusters getter
-    [[nodiscard]] std::map<int, Cluster> getClusters(int depth) const;
-    [[nodiscard]] const std::vector<std::map<int, Cluster>>& getClustersFull() const {return m_clusters;}
+    [[nodiscard]] std::span<const Cluster> getClusters(int depth) const;
+    // precomputed levels only (depths 2-6)
+    [[nodiscard]] const std::vector<ClusterLevel>& getClustersFull() const {return m_clusters;}
+    // cluster id of every paper at depth
+    [[nodiscard]] std::span<const std::uint16_t> getClusterIDs(int depth) const;
+    // indices of the papers in cluster id at depth (ascending), empty until all papers are loaded
+    [[nodiscard]] std::span<const std::uint32_t> getClusterMembers(int depth, int id) const;
+    [[nodiscard]] const ClusterMembers& getClusterMembersFull(int depth) const;
+    // explored papers of every cluster at depth once the animation passed the first numExplored papers (papers are
+    // explored in index order), indexed by cluster id. O(clusters * log(papers)) so any progress can be looked up,
+    // counts is left empty until the members are built (all papers are loaded)
+    void getExploredCounts(int depth, std::size_t numExplored, std::vector<ExploredCount>& counts) const;
+    // hierarchy of the precomputed levels, empty until all papers are loaded
+    [[nodiscard]] const ClusterTree& getClusterTree() const {return m_tree;}
     // stats getters
-    [[nodiscard]] unsigned int getNumPapers() const {return std::size(m_papers);}
+    [[nodiscard]] unsigned int getNumPapers() const {return m_papers.size();}
     [[nodiscard]] unsigned int getNumIncluded() const {return m_numIncluded;}
     [[nodiscard]] unsigned int getLastIndex() const {return m_lastIndex;}
     [[nodiscard]] unsigned int getPapersSize() const {return m_papersSize;}
     [[nodiscard]] unsigned int getVerticesSize() const {return m_verticesSize;}
+    // identifies the source file & scale (used to key caches built from the papers)
+    [[nodiscard]] const PaperCache::SourceInfo& getSourceInfo() const {return m_source;}
 
 private:
     // papers data
-    std::vector<Paper> m_papers{};
-    // cluster data
-    std::vector<std::map<int, Cluster>> m_clusters{};
+    PaperTable m_papers{};
+    // cluster data, one level per depth
+    std::vector<ClusterLevel> m_clusters{};
+    std::vector<ClusterMembers> m_members{};
+    // parent/child relations & stats of the precomputed clusters
+    ClusterTree m_tree{};
+    // k-means clusters, cleared whenever the papers change
+    std::vector<std::uint16_t> m_kmeansIDs{};
+    ClusterLevel m_kmeansClusters{};
+    ClusterMembers m_kmeansMembers{};
+    void clearKMeansClusters();
+
+    // streaming state, batches are published by the stream thread & consumed by pollBatches() on the main thread
+    void streamFile(std::string filename, float scale);
+    std::thread m_streamThread{};
+    std::mutex m_streamMutex{};
+    std::deque<PaperChunk> m_streamBatches{}; // guarded by m_streamMutex
+    bool m_streamDone{false}; // guarded by m_streamMutex
+    std::atomic<bool> m_streamCancel{false};
+    bool m_streaming{false};
+    // a batch couldn't be added, the rest of the file is skipped & the cache isn't written
+    bool m_streamFailed{false};
+    std::string m_streamFilename{};
+    // file (& scale) the papers were loaded from, set by load() & startStreaming()
+    PaperCache::SourceInfo m_source{};
 
     // stats
     unsigned int m_numIncluded{0}; // number of included papers
     unsigned int m_lastIndex{0}; // last index explored
-    unsigned int m_papersSize{0}; // size of papers vector in bytes
+    unsigned int m_papersSize{0}; // size of paper columns in bytes
     unsigned int m_verticesSize{0}; // size of vertices in bytes
 };
 
@@ -0,0 +1,321 @@
+/*
+ * Parquet backend for PaperLoader (only built with -DPV_WITH_PARQUET=ON).
+ * Columns are read by position and follow the csv layout, each row group becomes a PaperChunk.
+ */
+
+#include "paper_loader.h"
+
+#include "thread_pool.h"
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/file_reader.h>
+
+#include <iostream>
+#include <memory>
+
+namespace
+{
+    // columns in the file, same order as the fields of a csv row
+    constexpr int TITLE_COLUMN {0};
+    constexpr int INCLUDED_COLUMN {1};
+    constexpr int POSITION_COLUMN {2}; // x_2d, y_2d, x_3d, y_3d, z_3d
+    constexpr int CLUSTER_ID_COLUMN {7}; // 2_2d, 2_3d, 3_2d, ...
+    constexpr int LABEL_COLUMN {17}; // 2D labels for depth 2-6, then the 3D labels
+
+    template <typename ArrayType, typename F>
+    void visitValues(const arrow::Array& array, const std::size_t offset, F& f)
+    {
+        const auto& values {static_cast<const ArrayType&>(array)};
+        for (std::int64_t i{0}; i < values.length(); ++i)
+        {
+            // nulls are left untouched, like empty csv fields
+            if (values.IsValid(i))
+            {
+                f(offset + static_cast<std::size_t>(i), values.Value(i));
+            }
+        }
+    }
+
+    // calls f(row, value) for every number in column, returns false if the column isn't numeric
+    template <typename F>
+    bool forEachNumber(const arrow::ChunkedArray& column, F&& f)
+    {
+        std::size_t offset{0};
+        for (const std::shared_ptr<arrow::Array>& chunk : column.chunks())
+        {
+            switch (chunk->type_id())
+            {
+                case arrow::Type::DOUBLE:
+                    visitValues<arrow::DoubleArray>(*chunk, offset, f);
+                    break;
+                case arrow::Type::FLOAT:
+                    visitValues<arrow::FloatArray>(*chunk, offset, f);
+                    break;
+                case arrow::Type::INT64:
+                    visitValues<arrow::Int64Array>(*chunk, offset, f);
+                    break;
+                case arrow::Type::INT32:
+                    visitValues<arrow::Int32Array>(*chunk, offset, f);
+                    break;
+                case arrow::Type::INT16:
+                    visitValues<arrow::Int16Array>(*chunk, offset, f);
+                    break;
+                case arrow::Type::UINT16:
+                    visitValues<arrow::UInt16Array>(*chunk, offset, f);
+                    break;
+                case arrow::Type::INT8:
+                    visitValues<arrow::Int8Array>(*chunk, offset, f);
+                    break;
+                case arrow::Type::BOOL:
+                    visitValues<arrow::BooleanArray>(*chunk, offset, f);
+                    break;
+                default:
+                    return false;
+            }
+            offset += static_cast<std::size_t>(chunk->length());
+        }
+        return true;
+    }
+
+    // string_view of a string or large string array, empty for nulls
+    std::string_view getString(const arrow::Array& array, const std::int64_t i)
+    {
+        if (array.IsNull(i))
+        {
+            return {};
+        }
+        if (array.type_id() == arrow::Type::LARGE_STRING)
+        {
+            return static_cast<const arrow::LargeStringArray&>(array).GetView(i);
+        }
+        return static_cast<const arrow::StringArray&>(array).GetView(i);
+    }
+
+    [[nodiscard]] bool isString(const arrow::DataType& type)
+    {
+        return type.id() == arrow::Type::STRING || type.id() == arrow::Type::LARGE_STRING;
+    }
+
+    // calls f(row, str) for every string in column, returns false if the column isn't a string column
+    template <typename F>
+    bool forEachString(const arrow::ChunkedArray& column, F&& f)
+    {
+        std::size_t offset{0};
+        for (const std::shared_ptr<arrow::Array>& chunk : column.chunks())
+        {
+            if (!isString(*chunk->type()))
+            {
+                return false;
+            }
+            for (std::int64_t i{0}; i < chunk->length(); ++i)
+            {
+                f(offset + static_cast<std::size_t>(i), getString(*chunk, i));
+            }
+            offset += static_cast<std::size_t>(chunk->length());
+        }
+        return true;
+    }
+
+    // intern every label of column into the papers' dictionary for that label column
+    bool readLabels(const arrow::ChunkedArray& column, PaperTable& papers, const std::size_t labelColumn)
+    {
+        const std::span<std::uint16_t> codes {papers.editLabelCodes(labelColumn)};
+        std::size_t offset{0};
+        for (const std::shared_ptr<arrow::Array>& chunk : column.chunks())
+        {
+            if (chunk->type_id() == arrow::Type::DICTIONARY)
+            {
+                // dictionary encoded in the file, so each distinct label only has to be interned once
+                const auto& labels {static_cast<const arrow::DictionaryArray&>(*chunk)};
+                const arrow::Array& dictionary {*labels.dictionary()};
+                if (!isString(*dictionary.type()))
+                {
+                    return false;
+                }
+                std::vector<std::uint16_t> dictionaryCodes(static_cast<std::size_t>(dictionary.length()));
+                for (std::int64_t d{0}; d < dictionary.length(); ++d)
+                {
+                    if (!papers.internLabel(labelColumn, getString(dictionary, d), dictionaryCodes[static_cast<std::size_t>(d)]))
+                    {
+                        return false;
+                    }
+                }
+                // nulls become an empty label (only added if there are any)
+                std::uint16_t nullCode{0};
+                if (labels.null_count() > 0 && !papers.internLabel(labelColumn, {}, nullCode))
+                {
+                    return false;
+                }
+                for (std::int64_t i{0}; i < labels.length(); ++i)
+                {
+                    codes[offset + static_cast<std::size_t>(i)] = labels.IsValid(i) ? dictionaryCodes[static_cast<std::size_t>(labels.GetValueIndex(i))] : nullCode;
+                }
+            } else if (isString(*chunk->type()))
+            {
+                for (std::int64_t i{0}; i < chunk->length(); ++i)
+                {
+                    if (!papers.internLabel(labelColumn, getString(*chunk, i), codes[offset + static_cast<std::size_t>(i)]))
+                    {
+                        return false;
+                    }
+                }
+            } else
+            {
+                return false;
+            }
+            offset += static_cast<std::size_t>(chunk->length());
+        }
+        return true;
+    }
+
+    // decode one row group (already read into table) column by column into chunk
+    bool decodeRowGroup(const arrow::Table& table, const float scale, PaperChunk& chunk)
+    {
+        PaperTable& papers {chunk.papers};
+        const auto numRows {static_cast<std::size_t>(table.num_rows())};
+        papers.resize(numRows);
+
+        // titles
+        const std::span<TextHandle> titles {papers.editTitles()};
+        bool valid {forEachString(*table.column(TITLE_COLUMN), [&](const std::size_t row, const std::string_view title) {
+            titles[row] = papers.addText(title);
+        })};
+        // included flags
+        valid = valid && forEachNumber(*table.column(INCLUDED_COLUMN), [&](const std::size_t row, const auto included) {
+            papers.setIncluded(row, included != 0);
+        });
+        // 2D & 3D positions (scaled as double, stored as float)
+        const std::span<glm::vec2> pos2D {papers.editPositions2D()};
+        const std::span<glm::vec3> pos3D {papers.editPositions3D()};
+        for (int axis{0}; valid && axis < 5; ++axis)
+        {
+            valid = forEachNumber(*table.column(POSITION_COLUMN + axis), [&](const std::size_t row, const auto value) {
+                const auto pos {static_cast<float>(static_cast<double>(value) * scale)};
+                if (axis < 2) {
+                    pos2D[row][axis] = pos;
+                } else
+                {
+                    pos3D[row][axis - 2] = pos;
+                }
+            });
+        }
+        // cluster ids & labels
+        for (std::size_t c{0}; valid && c < NUM_CLUSTER_COLUMNS; ++c)
+        {
+            const std::span<std::uint16_t> clusterIDs {papers.editClusterIDs(c)};
+            valid = forEachNumber(*table.column(CLUSTER_ID_COLUMN + static_cast<int>(c)), [&](const std::size_t row, const auto id) {
+                clusterIDs[row] = static_cast<std::uint16_t>(id);
+            });
+        }
+        for (int depth{MIN_CLUSTER_DEPTH}; valid && depth <= MAX_CLUSTER_DEPTH; ++depth)
+        {
+            const int level {depth - MIN_CLUSTER_DEPTH};
+            valid = readLabels(*table.column(LABEL_COLUMN + level), papers, PaperTable::getClusterColumn(depth, CLUSTER_SPACE_2D))
+                    && readLabels(*table.column(LABEL_COLUMN + NUM_CLUSTER_LEVELS + level), papers, PaperTable::getClusterColumn(depth, CLUSTER_SPACE_3D));
+        }
+        if (!valid)
+        {
+            return false;
+        }
+
+        // stats
+        for (std::size_t i{0}; i < numRows; ++i)
+        {
+            if (papers.isIncluded(i))
+            {
+                ++chunk.included;
+                chunk.lastIncluded = static_cast<int>(i) + 1;
+            }
+        }
+        return true;
+    }
+
+    // every row group gets its own reader (FileReader isn't thread safe), the footer is only parsed once
+    std::unique_ptr<parquet::arrow::FileReader> openReader(const std::string& filename, const std::shared_ptr<parquet::FileMetaData>& metadata)
+    {
+        parquet::ArrowReaderProperties properties;
+        // row groups are already decoded in parallel
+        properties.set_use_threads(false);
+        // labels only have a handful of distinct values
+        for (int column{LABEL_COLUMN}; column < static_cast<int>(NUM_PAPER_FIELDS); ++column)
+        {
+            properties.set_read_dictionary(column, true);
+        }
+        parquet::arrow::FileReaderBuilder builder;
+        if (!builder.OpenFile(filename, /*memory_map=*/true, parquet::default_reader_properties(), metadata).ok())
+        {
+            return nullptr;
+        }
+        builder.properties(properties);
+        arrow::Result<std::unique_ptr<parquet::arrow::FileReader>> reader {builder.Build()};
+        return reader.ok() ? std::move(reader).ValueUnsafe() : nullptr;
+    }
+}
+
+bool PaperLoader::loadFromParquet(const std::string& filename, const float scale)
+{
+    // clear previous papers
+    m_papers.clear();
+
+    // read footer (schema & row group layout)
+    std::shared_ptr<parquet::FileMetaData> metadata;
+    {
+        parquet::arrow::FileReaderBuilder builder;
+        if (!builder.OpenFile(filename, /*memory_map=*/true).ok())
+        {
+            std::cerr << "Error: Failed to read file from path: `" << filename << "`" << std::endl;
+            return false;
+        }
+        metadata = builder.raw_reader()->metadata();
+    }
+    if (metadata->num_columns() < static_cast<int>(NUM_PAPER_FIELDS))
+    {
+        std::cerr << "ERROR::PAPER_LOADER::PARQUET: `" << filename << "` has " << metadata->num_columns() << " columns, expected " << NUM_PAPER_FIELDS << std::endl;
+        return false;
+    }
+
+    // only the paper columns are read (the file may have extra ones, e.g. an index)
+    std::vector<int> columns(NUM_PAPER_FIELDS);
+    for (std::size_t c{0}; c < columns.size(); ++c)
+    {
+        columns[c] = static_cast<int>(c);
+    }
+
+    // decode each row group on the worker pool
+    ThreadPool& pool {ThreadPool::shared()};
+    std::vector<PaperChunk> chunks(static_cast<std::size_t>(metadata->num_row_groups()));
+    std::vector<std::future<bool>> tasks;
+    tasks.reserve(chunks.size());
+    for (std::size_t rg{0}; rg < chunks.size(); ++rg)
+    {
+        tasks.push_back(pool.submit([&filename, &metadata, &columns, &chunks, rg, scale] {
+            const std::unique_ptr<parquet::arrow::FileReader> reader {openReader(filename, metadata)};
+            if (!reader)
+            {
+                return false;
+            }
+            const arrow::Result<std::shared_ptr<arrow::Table>> table {reader->ReadRowGroup(static_cast<int>(rg), columns)};
+            return table.ok() && decodeRowGroup(**table, scale, chunks[rg]);
+        }));
+    }
+    bool valid{true};
+    for (std::future<bool>& task : tasks)
+    {
+        valid = task.get() && valid;
+    }
+    if (!valid)
+    {
+        std::cerr << "ERROR::PAPER_LOADER::PARQUET: Failed to decode `" << filename << "` (unexpected column types or more than 65536 distinct labels in a column?)" << std::endl;
+        return false;
+    }
+
+    if (!mergeChunks(chunks))
+    {
+        std::cerr << "ERROR::PAPER_LOADER::PARQUET: Too many distinct cluster labels in `" << filename << "` (at most 65536 per column)" << std::endl;
+        return false;
+    }
+    std::cout << "Loaded parquet from `" << filename << "`. Rows: " << m_papers.size() << " | " << m_numIncluded << " included | " << m_lastIndex << " LII | " << chunks.size() << " row groups (" << m_papersSize / 1000000 << " MB)" << '\n';
+    return true;
+}
@@ -0,0 +1,265 @@
+#include "paper_octree.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // bits per axis of the morton codes (the top bits of the 16 bit quantized positions), also the max depth
+    constexpr int OCTREE_LEVELS {10};
+    // nodes with more instances are split (neighbouring leaves in view are merged into one draw, smaller leaves
+    // cull tighter & give finer level of detail cells)
+    constexpr std::uint32_t MAX_LEAF_INSTANCES {256};
+    // radius of a single paper (the cubes are 1 unit across)
+    constexpr float PAPER_RADIUS {0.5f};
+
+    // spread the low 10 bits of v so there are 2 zero bits between each of them
+    std::uint32_t spreadBits(std::uint32_t v)
+    {
+        v &= 0x3FF;
+        v = (v | (v << 16)) & 0x030000FF;
+        v = (v | (v << 8)) & 0x0300F00F;
+        v = (v | (v << 4)) & 0x030C30C3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    }
+
+    std::uint32_t getMortonCode(const PaperInstance& instance)
+    {
+        constexpr int shift {16 - OCTREE_LEVELS};
+        return spreadBits(instance.pos[0] >> shift) | (spreadBits(instance.pos[1] >> shift) << 1) | (spreadBits(instance.pos[2] >> shift) << 2);
+    }
+}
+
+void PaperOctree::build(const std::span<PaperInstance> instances, const InstanceBounds& bounds)
+{
+    clear();
+    if (instances.empty())
+    {
+        return;
+    }
+    // sort by morton code, instances of the same cell stay in exploration order
+    std::vector<std::uint64_t> keys(instances.size());
+    for (std::size_t i{0}; i < instances.size(); ++i)
+    {
+        keys[i] = static_cast<std::uint64_t>(getMortonCode(instances[i])) << 32 | i;
+    }
+    std::ranges::sort(keys);
+    const std::vector<PaperInstance> unsorted {instances.begin(), instances.end()};
+    std::vector<std::uint32_t> codes(instances.size());
+    for (std::size_t i{0}; i < instances.size(); ++i)
+    {
+        instances[i] = unsorted[keys[i] & 0xFFFFFFFF];
+        codes[i] = static_cast<std::uint32_t>(keys[i] >> 32);
+    }
+    m_numInstances = instances.size();
+
+    m_nodes.push_back({0, static_cast<std::uint32_t>(instances.size())});
+    split(0, 0, codes);
+
+    // stats of the leaves from their papers, then of the parents (children come after their parent)
+    const glm::vec3 toWorld {bounds.size / 65535.0f};
+    for (std::size_t n{m_nodes.size()}; n-- > 0;)
+    {
+        OctreeNode& node {m_nodes[n]};
+        if (node.numChildren == 0)
+        {
+            glm::vec3 min {65535.0f};
+            glm::vec3 max {0.0f};
+            glm::dvec3 sum {0.0};
+            for (const PaperInstance& instance : instances.subspan(node.first, node.count))
+            {
+                const glm::vec3 pos {instance.pos[0], instance.pos[1], instance.pos[2]};
+                min = glm::min(min, pos);
+                max = glm::max(max, pos);
+                sum += glm::dvec3{pos};
+                node.numIncluded += (instance.flags & INSTANCE_INCLUDED) != 0;
+            }
+            node.min = bounds.min + min * toWorld;
+            node.max = bounds.min + max * toWorld;
+            node.center = bounds.min + glm::vec3{sum / static_cast<double>(node.count)} * toWorld;
+            m_leafFirsts.push_back(node.first);
+            continue;
+        }
+        node.min = m_nodes[node.firstChild].min;
+        node.max = m_nodes[node.firstChild].max;
+        glm::vec3 sum {0.0f};
+        for (std::uint32_t child{node.firstChild}; child < node.firstChild + node.numChildren; ++child)
+        {
+            node.min = glm::min(node.min, m_nodes[child].min);
+            node.max = glm::max(node.max, m_nodes[child].max);
+            sum += m_nodes[child].center * static_cast<float>(m_nodes[child].count);
+            node.numIncluded += m_nodes[child].numIncluded;
+        }
+        node.center = sum / static_cast<float>(node.count);
+    }
+
+    // order indices sorted within each leaf (included papers in the lowest bit while sorting)
+    std::ranges::sort(m_leafFirsts);
+    std::vector<std::uint64_t> orders(instances.size());
+    for (std::size_t i{0}; i < instances.size(); ++i)
+    {
+        orders[i] = static_cast<std::uint64_t>(instances[i].order) << 1 | ((instances[i].flags & INSTANCE_INCLUDED) != 0);
+    }
+    for (std::size_t leaf{0}; leaf < m_leafFirsts.size(); ++leaf)
+    {
+        const std::size_t last {leaf + 1 < m_leafFirsts.size() ? m_leafFirsts[leaf + 1] : instances.size()};
+        std::sort(orders.begin() + m_leafFirsts[leaf], orders.begin() + static_cast<std::ptrdiff_t>(last));
+    }
+    m_orders.resize(instances.size());
+    m_includedPrefix.resize(instances.size() + 1);
+    m_includedPrefix[0] = 0;
+    for (std::size_t i{0}; i < instances.size(); ++i)
+    {
+        m_orders[i] = static_cast<std::uint32_t>(orders[i] >> 1);
+        m_includedPrefix[i + 1] = m_includedPrefix[i] + static_cast<std::uint32_t>(orders[i] & 1);
+    }
+}
+
+void PaperOctree::split(const std::uint32_t node, const int level, const std::span<const std::uint32_t> codes)
+{
+    const OctreeNode parent {m_nodes[node]};
+    if (parent.count <= MAX_LEAF_INSTANCES || level >= OCTREE_LEVELS)
+    {
+        return;
+    }
+    // codes are sorted, so the instances of each octant are a sub-range
+    const int shift {3 * (OCTREE_LEVELS - 1 - level)};
+    const std::uint32_t firstChild {static_cast<std::uint32_t>(m_nodes.size())};
+    const std::uint32_t last {parent.first + parent.count};
+    std::uint32_t first {parent.first};
+    while (first < last)
+    {
+        const std::uint32_t octant {codes[first] >> shift};
+        const auto next {std::partition_point(codes.begin() + first, codes.begin() + last,
+                                              [octant, shift](const std::uint32_t code) {return code >> shift == octant;})};
+        const std::uint32_t end {static_cast<std::uint32_t>(next - codes.begin())};
+        m_nodes.push_back({first, end - first});
+        first = end;
+    }
+    m_nodes[node].firstChild = firstChild;
+    m_nodes[node].numChildren = static_cast<std::uint32_t>(m_nodes.size()) - firstChild;
+    for (std::uint32_t child{firstChild}; child < m_nodes[node].firstChild + m_nodes[node].numChildren; ++child)
+    {
+        split(child, level + 1, codes);
+    }
+}
+
+void PaperOctree::clear()
+{
+    m_nodes.clear();
+    m_numInstances = 0;
+    m_leafFirsts.clear();
+    m_orders.clear();
+    m_includedPrefix.clear();
+}
+
+void PaperOctree::cull(const glm::mat4& viewProjection, const float margin, std::vector<DrawRange>& ranges) const
+{
+    std::vector<std::uint32_t> splats;
+    cull(viewProjection, margin, 0.0f, 0.0f, ranges, splats);
+}
+
+void PaperOctree::cull(const glm::mat4& viewProjection, const float margin, const float pixelScale, const float splatSize,
+                       std::vector<DrawRange>& ranges, std::vector<std::uint32_t>& splats) const
+{
+    ranges.clear();
+    splats.clear();
+    if (m_nodes.empty())
+    {
+        return;
+    }
+    // frustum planes (pointing inwards) from the rows of the matrix
+    const glm::mat4 rows {glm::transpose(viewProjection)};
+    const glm::vec4 planes[6] {rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1],
+                               rows[3] - rows[1], rows[3] + rows[2], rows[3] - rows[2]};
+
+    // depth first in child order, so the ranges come out in instance order
+    std::vector<std::uint32_t> stack {0};
+    while (!stack.empty())
+    {
+        const std::uint32_t index {stack.back()};
+        const OctreeNode& node {m_nodes[index]};
+        stack.pop_back();
+        const glm::vec3 min {node.min - margin};
+        const glm::vec3 max {node.max + margin};
+        bool outside{false};
+        bool inside{true};
+        for (const glm::vec4& plane : planes)
+        {
+            // corners of the box furthest along & against the plane normal
+            const glm::vec3 normal {plane};
+            const glm::vec3 positive {glm::mix(min, max, glm::greaterThanEqual(normal, glm::vec3{0.0f}))};
+            const glm::vec3 negative {glm::mix(max, min, glm::greaterThanEqual(normal, glm::vec3{0.0f}))};
+            if (glm::dot(normal, positive) + plane.w < 0.0f)
+            {
+                outside = true;
+                break;
+            }
+            inside = inside && glm::dot(normal, negative) + plane.w >= 0.0f;
+        }
+        if (outside)
+        {
+            continue;
+        }
+        // size of the box on screen, from its distance along the view direction (w) in front of the camera
+        const float distance {glm::dot(glm::vec3{rows[3]}, node.center) + rows[3].w};
+        if (splatSize > 0.0f && distance > 0.0f && glm::length(max - min) * pixelScale <= splatSize * distance)
+        {
+            splats.push_back(index);
+            continue;
+        }
+        // nodes inside the frustum are still split for the level of detail
+        if ((!inside || splatSize > 0.0f) && node.numChildren > 0)
+        {
+            for (std::uint32_t child{node.firstChild + node.numChildren}; child-- > node.firstChild;)
+            {
+                stack.push_back(child);
+            }
+            continue;
+        }
+        if (!ranges.empty() && ranges.back().first + ranges.back().count == node.first)
+        {
+            ranges.back().count += node.count;
+        } else
+        {
+            ranges.push_back({node.first, node.count});
+        }
+    }
+}
+
+void PaperOctree::getExploredCounts(const std::span<const std::uint32_t> nodes, const std::uint32_t numExplored, std::vector<ExploredCount>& counts) const
+{
+    counts.assign(nodes.size(), {});
+    for (std::size_t n{0}; n < nodes.size(); ++n)
+    {
+        const OctreeNode& node {m_nodes[nodes[n]]};
+        // leaves of the node are the ones that start within its range
+        for (auto leaf {std::ranges::lower_bound(m_leafFirsts, node.first)}; leaf != m_leafFirsts.end() && *leaf < node.first + node.count; ++leaf)
+        {
+            const std::uint32_t last {std::next(leaf) != m_leafFirsts.end() ? *std::next(leaf) : static_cast<std::uint32_t>(m_numInstances)};
+            const auto first {m_orders.begin() + *leaf};
+            const std::uint32_t explored {static_cast<std::uint32_t>(std::lower_bound(first, m_orders.begin() + last, numExplored) - first)};
+            counts[n].numPapers += static_cast<int>(explored);
+            counts[n].numIncluded += static_cast<int>(m_includedPrefix[*leaf + explored] - m_includedPrefix[*leaf]);
+        }
+    }
+}
+
+void PaperOctree::getSplats(const std::span<const std::uint32_t> nodes, const std::uint32_t numExplored, std::vector<PaperSplat>& splats) const
+{
+    std::vector<ExploredCount> counts;
+    getExploredCounts(nodes, numExplored, counts);
+    splats.resize(nodes.size());
+    for (std::size_t n{0}; n < nodes.size(); ++n)
+    {
+        const OctreeNode& node {m_nodes[nodes[n]]};
+        PaperSplat& splat {splats[n]};
+        splat.center = node.center;
+        // as big as the papers would be packed together, but not bigger than the node
+        const float packed {PAPER_RADIUS * std::cbrt(static_cast<float>(node.count))};
+        splat.radius = std::max(PAPER_RADIUS, std::min(packed, glm::length(node.max - node.min) * 0.5f));
+        splat.included = counts[n].numPapers > 0 ? static_cast<float>(counts[n].numIncluded) / static_cast<float>(counts[n].numPapers) : 0.0f;
+        splat.explored = static_cast<float>(counts[n].numPapers) / static_cast<float>(node.count);
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * Spatial octree over the paper instances, so papers outside the view aren't drawn.
+ * The instances are sorted along a morton (z-order) curve of their quantized positions, which makes every node a
+ * contiguous range of the instance buffer. Each frame the nodes are culled against the view frustum & the visible
+ * ranges are drawn, the order index of the instances keeps the exploration colouring independent of their order.
+ * Nodes that are only a few pixels on screen can be drawn as a single splat instead (level of detail), with the
+ * explored & included papers of a node counted from the order indices sorted within each leaf.
+ */
+
+#ifndef PAPER_OCTREE_H
+#define PAPER_OCTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "paper_loader.h"
+
+struct OctreeNode
+{
+    // instances [first, first + count)
+    std::uint32_t first{0};
+    std::uint32_t count{0};
+    // children are nodes [firstChild, firstChild + numChildren), a leaf has none
+    std::uint32_t firstChild{0};
+    std::uint32_t numChildren{0};
+    std::uint32_t numIncluded{0};
+    // bounding box & mean of the paper positions
+    glm::vec3 min{0.0f};
+    glm::vec3 max{0.0f};
+    glm::vec3 center{0.0f};
+};
+
+// range of instances to draw
+struct DrawRange
+{
+    std::uint32_t first{0};
+    std::uint32_t count{0};
+};
+
+// node drawn as a single point (24 bytes), the radius grows with the number of papers
+struct PaperSplat
+{
+    glm::vec3 center;
+    float radius;
+    // fraction of the explored papers that are included & fraction of the papers that are explored
+    float included;
+    float explored;
+};
+static_assert(sizeof(PaperSplat) == 24);
+
+class PaperOctree
+{
+public:
+    // reorder instances spatially & build the nodes over them, bounds are the ones the instances are quantized within
+    void build(std::span<PaperInstance> instances, const InstanceBounds& bounds);
+    void clear();
+
+    [[nodiscard]] bool empty() const {return m_nodes.empty();}
+    // instances [0, getNumInstances()) are in the octree
+    [[nodiscard]] std::size_t getNumInstances() const {return m_numInstances;}
+    [[nodiscard]] std::span<const OctreeNode> getNodes() const {return m_nodes;}
+
+    // instance ranges of the leaves that intersect the frustum of viewProjection, in instance order with
+    // neighbouring ranges merged, margin pads the boxes (papers aren't points)
+    void cull(const glm::mat4& viewProjection, float margin, std::vector<DrawRange>& ranges) const;
+    // like cull, but visible nodes whose box is at most splatSize pixels across are added to splats instead of
+    // their ranges, pixelScale is pixels per unit at distance 1 (projection[1][1] * viewport height / 2)
+    void cull(const glm::mat4& viewProjection, float margin, float pixelScale, float splatSize,
+              std::vector<DrawRange>& ranges, std::vector<std::uint32_t>& splats) const;
+
+    // papers with an order index below numExplored (& how many of them are included) in each of nodes
+    void getExploredCounts(std::span<const std::uint32_t> nodes, std::uint32_t numExplored, std::vector<ExploredCount>& counts) const;
+    // splats of nodes once the papers with an order index below numExplored have been explored
+    void getSplats(std::span<const std::uint32_t> nodes, std::uint32_t numExplored, std::vector<PaperSplat>& splats) const;
+
+private:
+    // split node into its octants at level (0 is the root), codes are the sorted morton codes of the instances
+    void split(std::uint32_t node, int level, std::span<const std::uint32_t> codes);
+
+    // root is node 0, children come after their parent
+    std::vector<OctreeNode> m_nodes{};
+    std::size_t m_numInstances{0};
+    // first instance of every leaf (ascending)
+    std::vector<std::uint32_t> m_leafFirsts{};
+    // order indices of the instances, sorted within each leaf
+    std::vector<std::uint32_t> m_orders{};
+    // included papers in m_orders[0, i)
+    std::vector<std::uint32_t> m_includedPrefix{};
+};
+
+#endif
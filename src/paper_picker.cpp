@@ -0,0 +1,139 @@
+#include "paper_picker.h"
+
+#include <iostream>
+#include <limits>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+void PaperPicker::init()
+{
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, PICK_SIZE, PICK_SIZE, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+
+    glGenRenderbuffers(1, &m_depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, PICK_SIZE, PICK_SIZE);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depth);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "ERROR::FRAMEBUFFER Pick framebuffer is not complete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenBuffers(NUM_PICK_BUFFERS, m_buffers);
+    for (const unsigned int buffer : m_buffers)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, PICK_SIZE * PICK_SIZE * sizeof(std::uint32_t), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void PaperPicker::free()
+{
+    for (GLsync& fence : m_fences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    glDeleteBuffers(NUM_PICK_BUFFERS, m_buffers);
+    glDeleteRenderbuffers(1, &m_depth);
+    glDeleteTextures(1, &m_texture);
+    glDeleteFramebuffers(1, &m_framebuffer);
+}
+
+bool PaperPicker::begin(const glm::vec2 cursor, const int width, const int height, glm::mat4& projection)
+{
+    // every buffer is still waiting for the gpu
+    if (m_fences[m_buffer] != nullptr || width <= 0 || height <= 0)
+    {
+        return false;
+    }
+    // scale the region around the cursor up to the whole clip space (like gluPickMatrix)
+    const glm::vec2 size {static_cast<float>(width), static_cast<float>(height)};
+    const glm::vec2 center {cursor / size * 2.0f - 1.0f};
+    const glm::vec2 scale {size / static_cast<float>(PICK_SIZE)};
+    projection = glm::translate(glm::scale(glm::mat4{1.0f}, glm::vec3{scale, 1.0f}), glm::vec3{-center, 0.0f}) * projection;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, PICK_SIZE, PICK_SIZE);
+    constexpr GLuint clearID[4] {0, 0, 0, 0};
+    glClearBufferuiv(GL_COLOR, 0, clearID);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    return true;
+}
+
+void PaperPicker::end()
+{
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffers[m_buffer]);
+    glReadPixels(0, 0, PICK_SIZE, PICK_SIZE, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_fences[m_buffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_picks[m_buffer] = ++m_numPicks;
+    m_buffer = (m_buffer + 1) % NUM_PICK_BUFFERS;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+bool PaperPicker::poll()
+{
+    const int lastPicked {m_pickedPaper};
+    for (int b{0}; b < NUM_PICK_BUFFERS; ++b)
+    {
+        if (m_fences[b] == nullptr)
+        {
+            continue;
+        }
+        const GLenum status {glClientWaitSync(m_fences[b], 0, 0)};
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            continue;
+        }
+        glDeleteSync(m_fences[b]);
+        m_fences[b] = nullptr;
+        if (m_picks[b] < m_lastRead)
+        {
+            continue;
+        }
+        m_lastRead = m_picks[b];
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffers[b]);
+        const auto* ids {static_cast<const std::uint32_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, PICK_SIZE * PICK_SIZE * sizeof(std::uint32_t), GL_MAP_READ_BIT))};
+        if (ids != nullptr)
+        {
+            // paper closest to the center pixel
+            constexpr int center {PICK_SIZE / 2};
+            int closest {std::numeric_limits<int>::max()};
+            m_pickedPaper = -1;
+            for (int y{0}; y < PICK_SIZE; ++y)
+            {
+                for (int x{0}; x < PICK_SIZE; ++x)
+                {
+                    const std::uint32_t id {ids[y * PICK_SIZE + x]};
+                    const int distance {(x - center) * (x - center) + (y - center) * (y - center)};
+                    if (id != 0 && distance < closest)
+                    {
+                        closest = distance;
+                        m_pickedPaper = static_cast<int>(id - 1);
+                    }
+                }
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    return m_pickedPaper != lastPicked;
+}
@@ -0,0 +1,53 @@
+/*
+ * Picking the paper under the cursor with an id buffer.
+ * Papers in a small region around the cursor are rendered with their order index (+ 1, 0 is nothing) into an
+ * integer framebuffer, which is copied into a pixel buffer object. The copy is only mapped once its fence has
+ * signalled, a frame (or more) later, so picking never stalls the pipeline.
+ */
+
+#ifndef PAPER_PICKER_H
+#define PAPER_PICKER_H
+
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// the pick region is PICK_SIZE x PICK_SIZE pixels centered on the cursor (odd, so there's a center pixel)
+constexpr int PICK_SIZE {7};
+// readbacks in flight
+constexpr int NUM_PICK_BUFFERS {3};
+
+class PaperPicker
+{
+public:
+    void init();
+    void free();
+
+    // bind & clear the pick framebuffer if a pixel buffer is free, projection is narrowed to the region around
+    // cursor (in pixels of the width x height viewport, origin at the bottom left)
+    // the papers are then drawn writing their order index + 1
+    [[nodiscard]] bool begin(glm::vec2 cursor, int width, int height, glm::mat4& projection);
+    // queue the copy of the region into the pixel buffer & unbind the framebuffer (the viewport has to be restored)
+    void end();
+    // read the copies that are done without waiting for the others, returns true if the picked paper changed
+    bool poll();
+
+    // order index of the paper under the cursor (or the closest one in the region) in the latest pick, -1 if none
+    [[nodiscard]] int getPickedPaper() const {return m_pickedPaper;}
+
+private:
+    unsigned int m_framebuffer{0};
+    unsigned int m_texture{0};
+    unsigned int m_depth{0};
+    unsigned int m_buffers[NUM_PICK_BUFFERS]{};
+    GLsync m_fences[NUM_PICK_BUFFERS]{};
+    // pick number of each buffer, so an older pick that finishes late doesn't replace a newer one
+    std::uint64_t m_picks[NUM_PICK_BUFFERS]{};
+    std::uint64_t m_numPicks{0};
+    std::uint64_t m_lastRead{0};
+    int m_buffer{0};
+    int m_pickedPaper{-1};
+};
+
+#endif
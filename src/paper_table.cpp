@@ -0,0 +1,353 @@
+#include "paper_table.h"
+
+#include "paper_cache.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+    // append utf-8 str to out (string or vector<char>), invalid bytes are replaced with U+FFFD
+    // so the stored text is always valid utf-8
+    template <typename Out>
+    void appendUtf8(const std::string_view str, Out& out)
+    {
+        constexpr std::string_view REPLACEMENT {"\xEF\xBF\xBD"};
+        std::size_t i{0};
+        while (i < str.size())
+        {
+            // copy runs of ascii in one go
+            std::size_t run {i};
+            while (run < str.size() && static_cast<unsigned char>(str[run]) < 0x80)
+            {
+                ++run;
+            }
+            out.insert(out.end(), str.begin() + static_cast<std::ptrdiff_t>(i), str.begin() + static_cast<std::ptrdiff_t>(run));
+            i = run;
+            if (i >= str.size())
+            {
+                break;
+            }
+            // length of the sequence from the lead byte
+            const auto c {static_cast<unsigned char>(str[i])};
+            std::size_t len{0};
+            if ((c & 0xE0) == 0xC0) {
+                len = 2;
+            } else if ((c & 0xF0) == 0xE0) {
+                len = 3;
+            } else if ((c & 0xF8) == 0xF0) {
+                len = 4;
+            }
+            bool valid {len != 0 && i + len <= str.size()};
+            for (std::size_t j{1}; valid && j < len; ++j)
+            {
+                valid = (static_cast<unsigned char>(str[i + j]) & 0xC0) == 0x80;
+            }
+            if (!valid)
+            {
+                out.insert(out.end(), REPLACEMENT.begin(), REPLACEMENT.end());
+                ++i;
+                continue;
+            }
+            out.insert(out.end(), str.begin() + static_cast<std::ptrdiff_t>(i), str.begin() + static_cast<std::ptrdiff_t>(i + len));
+            i += len;
+        }
+    }
+}
+
+void PaperTable::clear()
+{
+    m_pos3D.setView({});
+    m_pos2D.setView({});
+    m_included.setView({});
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        m_clusterIDs[c].setView({});
+        m_clusterLabels[c].setView({});
+        m_labelDictionaries[c].clear();
+    }
+    m_titles.setView({});
+    m_text.setView({});
+    m_file.close();
+}
+
+void PaperTable::reserve(const std::size_t numPapers)
+{
+    m_pos3D.values().reserve(numPapers);
+    m_pos2D.values().reserve(numPapers);
+    m_included.values().reserve((numPapers + 63) / 64);
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        m_clusterIDs[c].values().reserve(numPapers);
+        m_clusterLabels[c].values().reserve(numPapers);
+    }
+    m_titles.values().reserve(numPapers);
+}
+
+void PaperTable::resize(const std::size_t numPapers)
+{
+    m_pos3D.values().resize(numPapers);
+    m_pos2D.values().resize(numPapers);
+    std::vector<std::uint64_t>& included {m_included.values()};
+    included.resize((numPapers + 63) / 64, 0);
+    // clear bits past the end, so growing again starts with zeroed rows
+    if ((numPapers & 63) != 0)
+    {
+        included.back() &= (std::uint64_t{1} << (numPapers & 63)) - 1;
+    }
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        m_clusterIDs[c].values().resize(numPapers);
+        m_clusterLabels[c].values().resize(numPapers);
+    }
+    m_titles.values().resize(numPapers);
+}
+
+void PaperTable::setIncluded(const std::size_t index, const bool included)
+{
+    std::uint64_t& word {m_included.values()[index >> 6]};
+    const std::uint64_t bit {std::uint64_t{1} << (index & 63)};
+    word = included ? word | bit : word & ~bit;
+}
+
+void PaperTable::push(const PaperRow& row)
+{
+    const std::size_t index {size()};
+    std::vector<std::uint64_t>& included {m_included.values()};
+    if ((index & 63) == 0)
+    {
+        included.push_back(0);
+    }
+    included.back() |= static_cast<std::uint64_t>(row.included) << (index & 63);
+    m_pos3D.values().push_back(row.pos3D);
+    m_pos2D.values().push_back(row.pos2D);
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        m_clusterIDs[c].values().push_back(row.clusterIDs[c]);
+        m_clusterLabels[c].values().push_back(row.clusterLabels[c]);
+    }
+    m_titles.values().push_back(row.title);
+}
+
+bool PaperTable::append(PaperTable&& other)
+{
+    if (empty())
+    {
+        *this = std::move(other);
+        return true;
+    }
+    // map the codes of the other dictionaries to codes in ours first, so nothing is appended if they don't fit
+    std::array<std::vector<std::uint16_t>, NUM_CLUSTER_COLUMNS> remaps;
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        const LabelDictionary& otherLabels {other.m_labelDictionaries[c]};
+        remaps[c].resize(otherLabels.size());
+        for (std::size_t code{0}; code < remaps[c].size(); ++code)
+        {
+            if (!m_labelDictionaries[c].intern(otherLabels.getKey(static_cast<std::uint16_t>(code)), remaps[c][code]))
+            {
+                return false;
+            }
+        }
+    }
+    const std::size_t offset {size()};
+    const std::uint64_t textOffset {m_text.size()};
+    const auto rebase = [textOffset](TextHandle handle) {
+        handle.offset += textOffset;
+        return handle;
+    };
+    const auto insert = []<typename T>(Column<T>& column, const Column<T>& from) {
+        std::vector<T>& values {column.values()};
+        values.insert(values.end(), from.span().begin(), from.span().end());
+    };
+
+    insert(m_pos3D, other.m_pos3D);
+    insert(m_pos2D, other.m_pos2D);
+    // included bits are shifted by however far the last word is filled
+    std::vector<std::uint64_t>& included {m_included.values()};
+    included.resize((offset + other.size() + 63) / 64, 0);
+    for (std::size_t w{0}; w < other.m_included.size(); ++w)
+    {
+        const std::uint64_t bits {other.m_included[w]};
+        const std::size_t start {offset + w * 64};
+        included[start >> 6] |= bits << (start & 63);
+        if ((start & 63) != 0 && (start >> 6) + 1 < included.size())
+        {
+            included[(start >> 6) + 1] |= bits >> (64 - (start & 63));
+        }
+    }
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        insert(m_clusterIDs[c], other.m_clusterIDs[c]);
+        std::ranges::transform(other.m_clusterLabels[c].span(), std::back_inserter(m_clusterLabels[c].values()),
+                               [&remap = remaps[c]](const std::uint16_t code) { return remap[code]; });
+    }
+    std::ranges::transform(other.m_titles.span(), std::back_inserter(m_titles.values()), rebase);
+    insert(m_text, other.m_text);
+    other.clear();
+    return true;
+}
+
+bool LabelDictionary::intern(const std::string_view utf8, std::uint16_t& code)
+{
+    if (const auto it {m_codes.find(utf8)}; it != m_codes.end())
+    {
+        code = it->second;
+        return true;
+    }
+    // a new label past the last code would alias the label of code 0
+    if (m_labels.size() > UINT16_MAX)
+    {
+        return false;
+    }
+    code = static_cast<std::uint16_t>(m_labels.size());
+    m_codes.emplace(std::string{utf8}, code);
+    m_keys.emplace_back(utf8);
+    appendUtf8(utf8, m_labels.emplace_back());
+    return true;
+}
+
+void LabelDictionary::clear()
+{
+    m_labels.clear();
+    m_keys.clear();
+    m_codes.clear();
+}
+
+std::size_t LabelDictionary::getMemoryUsage() const
+{
+    std::size_t bytes{0};
+    for (std::size_t i{0}; i < m_labels.size(); ++i)
+    {
+        // label, key & the map's copy of the key
+        bytes += m_labels[i].size() + m_keys[i].size() * 2;
+    }
+    return bytes;
+}
+
+TextHandle PaperTable::addText(const std::string_view str)
+{
+    const std::uint64_t offset {m_text.size()};
+    appendUtf8(str, m_text.values());
+    return {offset, static_cast<std::uint32_t>(m_text.size() - offset)};
+}
+
+// columns are ordered like the csv file: 2_2d, 2_3d, 3_2d, 3_3d, ...
+std::size_t PaperTable::getClusterColumn(int depth, const ClusterSpace space)
+{
+    depth = std::max(MIN_CLUSTER_DEPTH, std::min(MAX_CLUSTER_DEPTH, depth));
+    return static_cast<std::size_t>(depth - MIN_CLUSTER_DEPTH) * 2 + (space == CLUSTER_SPACE_3D ? 1 : 0);
+}
+
+std::span<const std::uint16_t> PaperTable::getClusterIDs(const int depth, const ClusterSpace space) const
+{
+    return m_clusterIDs[getClusterColumn(depth, space)].span();
+}
+
+std::uint16_t PaperTable::getClusterID(const std::size_t index, const int depth, const ClusterSpace space) const
+{
+    return m_clusterIDs[getClusterColumn(depth, space)][index];
+}
+
+std::span<const std::uint16_t> PaperTable::getLabelCodes(const int depth, const ClusterSpace space) const
+{
+    return m_clusterLabels[getClusterColumn(depth, space)].span();
+}
+
+const LabelDictionary& PaperTable::getLabelDictionary(const int depth, const ClusterSpace space) const
+{
+    return m_labelDictionaries[getClusterColumn(depth, space)];
+}
+
+std::string_view PaperTable::getClusterLabel(const std::size_t index, const int depth, const ClusterSpace space) const
+{
+    const std::size_t column {getClusterColumn(depth, space)};
+    return m_labelDictionaries[column].getLabel(m_clusterLabels[column][index]);
+}
+
+std::size_t PaperTable::getMemoryUsage() const
+{
+    std::size_t bytes {m_pos3D.size() * sizeof(glm::vec3) + m_pos2D.size() * sizeof(glm::vec2)
+                       + m_included.size() * sizeof(std::uint64_t) + m_titles.size() * sizeof(TextHandle)
+                       + m_text.size()};
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        bytes += m_clusterIDs[c].size() * sizeof(std::uint16_t) + m_clusterLabels[c].size() * sizeof(std::uint16_t)
+                 + m_labelDictionaries[c].getMemoryUsage();
+    }
+    return bytes;
+}
+
+void PaperTable::save(PaperCache::Writer& writer) const
+{
+    writer.writeArray(m_pos3D.span());
+    writer.writeArray(m_pos2D.span());
+    writer.writeArray(m_included.span());
+    for (std::size_t c{0}; c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        writer.writeArray(m_clusterIDs[c].span());
+        writer.writeArray(m_clusterLabels[c].span());
+        // dictionaries are tiny, so only the raw labels are stored (in code order)
+        const LabelDictionary& labels {m_labelDictionaries[c]};
+        writer.write<std::uint64_t>(labels.size());
+        for (std::size_t code{0}; code < labels.size(); ++code)
+        {
+            writer.writeString(labels.getKey(static_cast<std::uint16_t>(code)));
+        }
+    }
+    writer.writeArray(m_titles.span());
+    writer.writeArray(m_text.span());
+}
+
+bool PaperTable::load(PaperCache::Reader& reader)
+{
+    clear();
+    // reads a column as a view into the cache data, every column has to have a row per paper
+    const auto readColumn = [&reader]<typename T>(Column<T>& column, const std::size_t expected) {
+        std::span<const T> values;
+        if (!reader.readArray(values) || values.size() != expected)
+        {
+            return false;
+        }
+        column.setView(values);
+        return true;
+    };
+
+    std::span<const glm::vec3> pos3D;
+    if (!reader.readArray(pos3D))
+    {
+        return false;
+    }
+    m_pos3D.setView(pos3D);
+    const std::size_t numPapers {pos3D.size()};
+    bool valid {readColumn(m_pos2D, numPapers) && readColumn(m_included, (numPapers + 63) / 64)};
+    for (std::size_t c{0}; valid && c < NUM_CLUSTER_COLUMNS; ++c)
+    {
+        valid = readColumn(m_clusterIDs[c], numPapers) && readColumn(m_clusterLabels[c], numPapers);
+        std::uint64_t numLabels{0};
+        valid = valid && reader.read(numLabels);
+        for (std::uint64_t code{0}; valid && code < numLabels; ++code)
+        {
+            std::string_view label;
+            std::uint16_t labelCode{0};
+            valid = reader.readString(label) && m_labelDictionaries[c].intern(label, labelCode);
+        }
+        // every code has to point at a label
+        valid = valid && std::ranges::all_of(m_clusterLabels[c].span(), [numLabels](const std::uint16_t code) { return code < numLabels; });
+    }
+    std::span<const TextHandle> titles;
+    std::span<const char> text;
+    valid = valid && reader.readArray(titles) && titles.size() == numPapers && reader.readArray(text);
+    // every title has to be inside the text buffer
+    valid = valid && std::ranges::all_of(titles, [&text](const TextHandle handle) {
+        return handle.offset <= text.size() && handle.length <= text.size() - handle.offset;
+    });
+    if (!valid)
+    {
+        clear();
+        return false;
+    }
+    m_titles.setView(titles);
+    m_text.setView(text);
+    return true;
+}
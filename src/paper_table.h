@@ -0,0 +1,201 @@
+/*
+ * Columnar (structure of arrays) storage for papers.
+ * Each attribute lives in its own contiguous column, so passes that only need positions or cluster ids
+ * don't have to walk over titles and labels.
+ */
+
+#ifndef PAPER_TABLE_H
+#define PAPER_TABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "mapped_file.h"
+
+namespace PaperCache
+{
+    class Writer;
+    class Reader;
+}
+
+// precomputed cluster levels in the csv file (2^depth clusters, depth 2-6)
+constexpr int MIN_CLUSTER_DEPTH {2};
+constexpr int MAX_CLUSTER_DEPTH {6};
+constexpr int NUM_CLUSTER_LEVELS {MAX_CLUSTER_DEPTH - MIN_CLUSTER_DEPTH + 1};
+
+// each level was clustered in both 2D and 3D space
+enum ClusterSpace
+{
+    CLUSTER_SPACE_2D,
+    CLUSTER_SPACE_3D,
+};
+constexpr int NUM_CLUSTER_COLUMNS {NUM_CLUSTER_LEVELS * 2};
+
+// location of a string in the table's text buffer (the offset is 64 bit, so the buffer can grow past 4 GiB)
+struct TextHandle
+{
+    std::uint64_t offset{0};
+    std::uint32_t length{0};
+    // explicit, so the padding written to caches is always zero
+    std::uint32_t padding{0};
+};
+static_assert(sizeof(TextHandle) == 16);
+
+// column that either owns its values or views values owned by something else (a mapped cache file)
+template <typename T>
+class Column
+{
+public:
+    // owned values for writing, a viewed column is copied into owned storage first
+    std::vector<T>& values()
+    {
+        if (m_view.data() != nullptr)
+        {
+            m_values.assign(m_view.begin(), m_view.end());
+            m_view = {};
+        }
+        return m_values;
+    }
+    // view values without copying them, they must outlive the column (or the next call to values())
+    void setView(const std::span<const T> view)
+    {
+        m_values = {};
+        m_view = view;
+    }
+
+    [[nodiscard]] std::span<const T> span() const {return m_view.data() != nullptr ? m_view : std::span<const T>{m_values};}
+    [[nodiscard]] std::size_t size() const {return span().size();}
+    [[nodiscard]] const T& operator[](const std::size_t index) const {return span()[index];}
+
+private:
+    std::vector<T> m_values{};
+    std::span<const T> m_view{};
+};
+
+// distinct labels of one label column, papers only store the code (index) of their label
+class LabelDictionary
+{
+public:
+    // code of the label, the label is added (and decoded) the first time it's seen,
+    // returns false if it's new & all 65536 codes are taken
+    bool intern(std::string_view utf8, std::uint16_t& code);
+    void clear();
+
+    [[nodiscard]] std::size_t size() const {return m_labels.size();}
+    [[nodiscard]] std::string_view getLabel(const std::uint16_t code) const {return m_labels[code];}
+    // raw utf-8 of the label, used to merge dictionaries
+    [[nodiscard]] std::string_view getKey(const std::uint16_t code) const {return m_keys[code];}
+    [[nodiscard]] std::size_t getMemoryUsage() const;
+
+private:
+    // lets the map be searched with a string_view without building a std::string
+    struct KeyHash
+    {
+        using is_transparent = void;
+        std::size_t operator()(const std::string_view key) const {return std::hash<std::string_view>{}(key);}
+    };
+
+    // labels as valid utf-8 (keys are the raw bytes from the source file)
+    std::vector<std::string> m_labels{};
+    std::vector<std::string> m_keys{};
+    std::unordered_map<std::string, std::uint16_t, KeyHash, std::equal_to<>> m_codes{};
+};
+
+// all the data for one paper, used to append rows to the table
+struct PaperRow
+{
+    TextHandle title{};
+    bool included{false};
+    glm::vec2 pos2D{0.0f};
+    glm::vec3 pos3D{0.0f};
+    std::array<std::uint16_t, NUM_CLUSTER_COLUMNS> clusterIDs{};
+    // codes into the table's label dictionaries (see PaperTable::internLabel)
+    std::array<std::uint16_t, NUM_CLUSTER_COLUMNS> clusterLabels{};
+};
+
+class PaperTable
+{
+public:
+    PaperTable() = default;
+
+    void clear();
+    void reserve(std::size_t numPapers);
+
+    // add a paper to the end of the table
+    void push(const PaperRow& row);
+    // move all papers from other to the end of this table (text handles & label codes are rebased),
+    // returns false (and adds no papers) if the labels of a column don't fit in 16 bit codes
+    bool append(PaperTable&& other);
+
+    // ---- column at a time writes (for columnar sources like parquet) ---- //
+    // resize every column to numPapers rows, new rows are zeroed (label codes have to be set before they're read)
+    void resize(std::size_t numPapers);
+    [[nodiscard]] std::span<glm::vec3> editPositions3D() {return m_pos3D.values();}
+    [[nodiscard]] std::span<glm::vec2> editPositions2D() {return m_pos2D.values();}
+    [[nodiscard]] std::span<std::uint16_t> editClusterIDs(std::size_t column) {return m_clusterIDs[column].values();}
+    [[nodiscard]] std::span<std::uint16_t> editLabelCodes(std::size_t column) {return m_clusterLabels[column].values();}
+    [[nodiscard]] std::span<TextHandle> editTitles() {return m_titles.values();}
+    void setIncluded(std::size_t index, bool included);
+
+    // copy utf-8 into the text buffer (invalid bytes are replaced), returns handle to the copy
+    TextHandle addText(std::string_view str);
+    // add label to the dictionary of a label column, returns false if the dictionary is full (see LabelDictionary::intern)
+    bool internLabel(std::size_t column, std::string_view str, std::uint16_t& code) {return m_labelDictionaries[column].intern(str, code);}
+
+    // column index for a cluster level (depth 2-6)
+    [[nodiscard]] static std::size_t getClusterColumn(int depth, ClusterSpace space = CLUSTER_SPACE_3D);
+
+    // ---- column accessors ---- //
+    [[nodiscard]] std::size_t size() const {return m_pos3D.size();}
+    [[nodiscard]] bool empty() const {return m_pos3D.size() == 0;}
+
+    [[nodiscard]] std::span<const glm::vec3> getPositions3D() const {return m_pos3D.span();}
+    [[nodiscard]] std::span<const glm::vec2> getPositions2D() const {return m_pos2D.span();}
+    // included flags packed 64 per word
+    [[nodiscard]] std::span<const std::uint64_t> getIncludedBits() const {return m_included.span();}
+    [[nodiscard]] std::span<const std::uint16_t> getClusterIDs(int depth, ClusterSpace space = CLUSTER_SPACE_3D) const;
+    [[nodiscard]] std::span<const TextHandle> getTitles() const {return m_titles.span();}
+    [[nodiscard]] std::span<const std::uint16_t> getLabelCodes(int depth, ClusterSpace space = CLUSTER_SPACE_3D) const;
+    [[nodiscard]] const LabelDictionary& getLabelDictionary(int depth, ClusterSpace space = CLUSTER_SPACE_3D) const;
+
+    // ---- row accessors ---- //
+    [[nodiscard]] bool isIncluded(const std::size_t index) const {return (m_included[index >> 6] >> (index & 63)) & 1;}
+    [[nodiscard]] std::uint16_t getClusterID(std::size_t index, int depth, ClusterSpace space = CLUSTER_SPACE_3D) const;
+    [[nodiscard]] std::string_view getTitle(std::size_t index) const {return getText(m_titles[index]);}
+    [[nodiscard]] std::string_view getClusterLabel(std::size_t index, int depth, ClusterSpace space = CLUSTER_SPACE_3D) const;
+    [[nodiscard]] std::string_view getText(const TextHandle handle) const {return {m_text.span().data() + handle.offset, handle.length};}
+
+    // total size of all columns in bytes
+    [[nodiscard]] std::size_t getMemoryUsage() const;
+
+    // ---- snapshot cache (see paper_cache.h) ---- //
+    void save(PaperCache::Writer& writer) const;
+    // columns view the data in place, returns false (and leaves the table empty) if the data is malformed
+    bool load(PaperCache::Reader& reader);
+    // keep the mapped cache file alive while the columns view it
+    void attach(MappedFile&& file) {m_file = std::move(file);}
+
+private:
+    Column<glm::vec3> m_pos3D{};
+    Column<glm::vec2> m_pos2D{};
+    Column<std::uint64_t> m_included{};
+    std::array<Column<std::uint16_t>, NUM_CLUSTER_COLUMNS> m_clusterIDs{};
+    std::array<Column<std::uint16_t>, NUM_CLUSTER_COLUMNS> m_clusterLabels{};
+    std::array<LabelDictionary, NUM_CLUSTER_COLUMNS> m_labelDictionaries{};
+    Column<TextHandle> m_titles{};
+    // utf-8 arena for titles, addressed by TextHandle
+    Column<char> m_text{};
+    // cache file the columns were loaded from (if any)
+    MappedFile m_file{};
+};
+
+#endif
@@ -0,0 +1,10 @@
+#version 410 core
+// order index + 1, 0 is the background
+out uint PaperID;
+
+flat in uint Order;
+
+void main()
+{
+    PaperID = Order + 1u;
+}
@@ -0,0 +1,24 @@
+#version 410 core
+// papers as cubes (like pointsLighting.vert), writing their order index into the pick buffer
+layout (location = 0) in vec3 aPos;
+// quantized position within the instance bounds (normalized to [0, 1])
+layout (location = 2) in vec3 aOffset;
+// index in exploration order
+layout (location = 4) in uint aOrder;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+// box the instance positions are quantized within
+uniform vec3 boundsMin;
+uniform vec3 boundsSize;
+
+flat out uint Order;
+
+void main()
+{
+    Order = aOrder;
+    vec3 offset = boundsMin + aOffset * boundsSize;
+    gl_Position = projection * view * model * vec4(aPos + offset, 1.0);
+}
@@ -0,0 +1,69 @@
+#version 410 core
+out vec4 FragColor;
+
+in GS_OUT {
+    float Included;
+    float Explored;
+    vec3 ViewCenter;
+    vec3 ViewPos;
+    flat uint Order;
+} fs_in;
+
+uniform mat4 projection;
+uniform float radius;
+
+// same colours & lighting as the cubes (pointsLighting.frag), the light is at the camera
+const vec3 notIncluded = vec3(1.0, 0.0, 0.0);
+const vec3 included = vec3(0.0, 1.0, 0.0);
+const vec3 lightColor = vec3(1.0);
+
+const float lightConstant = 1.0;
+const float lightLinear = 0.00009;
+const float lightQuadratic = 0.000032;
+
+const float ambientStrength = 0.01;
+
+void main()
+{
+    // ray from the camera (view space origin) through this fragment of the quad, hitting the sphere
+    vec3 dir = normalize(fs_in.ViewPos);
+    float b = dot(dir, fs_in.ViewCenter);
+    float c = dot(fs_in.ViewCenter, fs_in.ViewCenter) - radius * radius;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0)
+        discard;
+    vec3 hit = dir * (b - sqrt(discriminant));
+
+    // depth of the sphere's surface, not the quad's
+    vec4 clip = projection * vec4(hit, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+    float dist = length(hit);
+    float attenuation = 1.0 / (lightConstant + lightLinear * dist + lightQuadratic * (dist * dist));
+
+    vec3 color;
+    if (fs_in.Included > 0.0)
+        color = included;
+    else
+        color = notIncluded;
+
+    // check if this paper was explored
+    if (fs_in.Explored < 1.0)
+        color = vec3(0.05);
+
+    // ambient lighting
+    vec3 ambient = ambientStrength * lightColor;
+
+    // diffuse
+    vec3 norm = (hit - fs_in.ViewCenter) / radius;
+    vec3 lightDir = -hit / dist;
+
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = diff * lightColor;
+
+    diffuse *= attenuation;
+
+    vec3 result = (ambient + diffuse) * color;
+
+    FragColor = vec4(result, 1.0);
+}
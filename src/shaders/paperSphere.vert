@@ -0,0 +1,33 @@
+#version 410 core
+// one vertex per paper, the geometry shader turns it into a camera facing quad around the sphere
+// quantized position within the instance bounds (normalized to [0, 1])
+layout (location = 0) in vec3 aOffset;
+// bit 0: included
+layout (location = 1) in uint aFlags;
+// index in exploration order
+layout (location = 2) in uint aOrder;
+
+uniform mat4 view;
+uniform mat4 model;
+
+// papers with an order index below numExplored have been explored (up to lastIndex)
+uniform uint numExplored;
+uniform uint lastIndex;
+// box the instance positions are quantized within
+uniform vec3 boundsMin;
+uniform vec3 boundsSize;
+
+out VS_OUT {
+    float Included;
+    float Explored;
+    vec3 ViewCenter;
+    flat uint Order;
+} vs_out;
+
+void main()
+{
+    vs_out.Included = float(aFlags & 1u);
+    vs_out.Explored = (aOrder < numExplored && aOrder <= lastIndex) ? 1.0 : 0.0;
+    vs_out.Order = aOrder;
+    vs_out.ViewCenter = vec3(view * model * vec4(boundsMin + aOffset * boundsSize, 1.0));
+}
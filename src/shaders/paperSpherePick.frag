@@ -0,0 +1,30 @@
+#version 410 core
+// order index + 1 of the sphere impostors (same intersection as paperSphere.frag), 0 is the background
+out uint PaperID;
+
+in GS_OUT {
+    float Included;
+    float Explored;
+    vec3 ViewCenter;
+    vec3 ViewPos;
+    flat uint Order;
+} fs_in;
+
+uniform mat4 projection;
+uniform float radius;
+
+void main()
+{
+    vec3 dir = normalize(fs_in.ViewPos);
+    float b = dot(dir, fs_in.ViewCenter);
+    float c = dot(fs_in.ViewCenter, fs_in.ViewCenter) - radius * radius;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0)
+        discard;
+    vec3 hit = dir * (b - sqrt(discriminant));
+
+    vec4 clip = projection * vec4(hit, 1.0);
+    gl_FragDepth = clip.z / clip.w * 0.5 + 0.5;
+
+    PaperID = fs_in.Order + 1u;
+}
@@ -0,0 +1,40 @@
+#version 410 core
+out vec4 FragColor;
+
+in VS_OUT {
+    vec2 Ratios;
+    float Dist;
+} fs_in;
+
+// same colours & lighting as the papers (pointsLighting.frag), mixed by the ratios of the node's papers
+const vec3 notIncluded = vec3(1.0, 0.0, 0.0);
+const vec3 included = vec3(0.0, 1.0, 0.0);
+const vec3 unexplored = vec3(0.05);
+const vec3 lightColor = vec3(1.0);
+
+const float lightConstant = 1.0;
+const float lightLinear = 0.00009;
+const float lightQuadratic = 0.000032;
+
+const float ambientStrength = 0.01;
+
+void main()
+{
+    // round splat, shaded like a sphere lit from the camera
+    vec2 coord = gl_PointCoord * 2.0 - 1.0;
+    float r2 = dot(coord, coord);
+    if (r2 > 1.0)
+        discard;
+    float diff = sqrt(1.0 - r2);
+
+    float attenuation = 1.0 / (lightConstant + lightLinear * fs_in.Dist + lightQuadratic * (fs_in.Dist * fs_in.Dist));
+
+    vec3 color = mix(unexplored, mix(notIncluded, included, fs_in.Ratios.x), fs_in.Ratios.y);
+
+    vec3 ambient = ambientStrength * lightColor;
+    vec3 diffuse = diff * lightColor * attenuation;
+
+    vec3 result = (ambient + diffuse) * color;
+
+    FragColor = vec4(result, 1.0);
+}
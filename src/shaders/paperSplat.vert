@@ -0,0 +1,26 @@
+#version 410 core
+// one point per distant octree node, standing in for all of its papers
+// center & radius of the splat
+layout (location = 0) in vec4 aCenterRadius;
+// fraction of the explored papers that are included & fraction of the papers that are explored
+layout (location = 1) in vec2 aRatios;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+// pixels per unit at distance 1
+uniform float pixelScale;
+
+out VS_OUT {
+    vec2 Ratios;
+    float Dist;
+} vs_out;
+
+void main()
+{
+    vs_out.Ratios = aRatios;
+    vec4 viewPos = view * model * vec4(aCenterRadius.xyz, 1.0);
+    vs_out.Dist = length(viewPos.xyz);
+    gl_Position = projection * viewPos;
+    gl_PointSize = max(1.0, 2.0 * aCenterRadius.w * pixelScale / gl_Position.w);
+}
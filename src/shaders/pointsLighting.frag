@@ -6,8 +6,7 @@ in VS_OUT {
     vec3 CameraPos;
     vec3 FragPos;
     vec3 Normal;
-    float Time;
-    float Counter;
+    float Explored;
 } vs_in;
 
 const vec3 notIncluded = vec3(1.0, 0.0, 0.0);
@@ -20,8 +19,6 @@ const float lightQuadratic = 0.000032;
 
 const float ambientStrength = 0.01;
 
-uniform int lastIndex;
-
 void main()
 {
     float dist = length(vs_in.CameraPos - vs_in.FragPos);
@@ -33,16 +30,8 @@ void main()
     else
         color = notIncluded;
 
-    float explored = 0.0;
-    float progress = vs_in.Time;
-    if (progress > vs_in.Counter)
-        explored = 1.0;
-    
     // check if this paper was explored
-    if (vs_in.Counter > lastIndex)
-        explored = 0.0;
-
-    if (explored < 1.0)
+    if (vs_in.Explored < 1.0)
         color = vec3(0.05);
     
     // ambient lighting
@@ -57,7 +46,6 @@ void main()
 
     diffuse *= attenuation;
 
-    float intensity = vs_in.Counter / 149945.0;
     vec3 result = (ambient + diffuse) * color;
 
     FragColor = vec4(result, 1.0);
@@ -1,9 +1,12 @@
 #version 410 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
+// quantized position within the instance bounds (normalized to [0, 1])
 layout (location = 2) in vec3 aOffset;
-layout (location = 3) in float aIncluded;
-layout (location = 4) in float aCounter;
+// bit 0: included
+layout (location = 3) in uint aFlags;
+// index in exploration order
+layout (location = 4) in uint aOrder;
 
 uniform mat4 projection;
 uniform mat4 view;
@@ -11,24 +14,28 @@ uniform mat4 model;
 
 uniform vec3 camerapos;
 
-uniform float time;
+// papers with an order index below numExplored have been explored (up to lastIndex)
+uniform uint numExplored;
+uniform uint lastIndex;
+// box the instance positions are quantized within
+uniform vec3 boundsMin;
+uniform vec3 boundsSize;
 
 out VS_OUT {
     float Included;
     vec3 CameraPos;
     vec3 FragPos;
     vec3 Normal;
-    float Time;
-    float Counter;
+    float Explored;
 } vs_out;
 
 void main()
 {
-    vs_out.Counter = aCounter;
-    vs_out.Included = aIncluded;
+    vs_out.Included = float(aFlags & 1u);
+    vs_out.Explored = (aOrder < numExplored && aOrder <= lastIndex) ? 1.0 : 0.0;
     vs_out.CameraPos = camerapos;
     vec3 uv = aPos; // can be modified
-//    float angle = aCounter;
+//    float angle = float(aOrder);
 //    mat3 rotmat = mat3 (
 //            0.0, 0.0, 0.0,
 //            0.0, cos(angle), sin(angle),
@@ -39,7 +46,7 @@ void main()
 //            -sin(angle * 1.5), 0.0, cos(angle * 1.5)
 //    );
     vs_out.Normal = aNormal;
-    vs_out.FragPos = vec3(model * vec4(uv + aOffset, 1.0));
-    vs_out.Time = time;
-    gl_Position = projection * view * model * vec4(uv + aOffset, 1.0);
+    vec3 offset = boundsMin + aOffset * boundsSize;
+    vs_out.FragPos = vec3(model * vec4(uv + offset, 1.0));
+    gl_Position = projection * view * model * vec4(uv + offset, 1.0);
 }
\ No newline at end of file
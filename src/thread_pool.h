@@ -0,0 +1,104 @@
+/*
+ * Small fixed-size worker pool for splitting loading work (parsing, cluster building) across cores.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool
+{
+public:
+    // 0 threads = one per hardware thread
+    explicit ThreadPool(unsigned int numThreads = 0)
+    {
+        if (numThreads == 0)
+        {
+            numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        m_workers.reserve(numThreads);
+        for (unsigned int i{0}; i < numThreads; ++i)
+        {
+            m_workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock{m_mutex};
+            m_stopping = true;
+        }
+        m_condition.notify_all();
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // queue a task, the future holds its result (or exception)
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        // std::function needs copyable callables, so wrap the packaged task in a shared_ptr
+        auto packaged {std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task))};
+        std::future<Result> future {packaged->get_future()};
+        {
+            std::lock_guard lock{m_mutex};
+            m_tasks.emplace([packaged] { (*packaged)(); });
+        }
+        m_condition.notify_one();
+        return future;
+    }
+
+    [[nodiscard]] unsigned int size() const {return static_cast<unsigned int>(m_workers.size());}
+
+    // pool shared by the loaders, created on first use
+    static ThreadPool& shared()
+    {
+        static ThreadPool pool{};
+        return pool;
+    }
+
+private:
+    std::vector<std::thread> m_workers{};
+    std::queue<std::function<void()>> m_tasks{};
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    bool m_stopping{false};
+
+    void workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock lock{m_mutex};
+                m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+                if (m_stopping && m_tasks.empty())
+                {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+#endif
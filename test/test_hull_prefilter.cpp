@@ -0,0 +1,96 @@
+// Checks that prefiltering the papers of a cluster (src/hull_builder.h) gives the same convex hull as building it
+// from all of them: the hull vertices have to be identical for point sets shaped in different ways.
+// usage: ./test_hull_prefilter (returns non-zero if a hull differs)
+
+#include "../src/hull_builder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // distinct corners of the hull's faces, sorted
+    std::vector<glm::dvec3> getHullVertices(const std::vector<glm::dvec3>& corners)
+    {
+        std::vector<glm::dvec3> vertices {corners};
+        const auto less = [](const glm::dvec3& a, const glm::dvec3& b) {
+            return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+        };
+        std::sort(vertices.begin(), vertices.end(), less);
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        return vertices;
+    }
+
+    // builds the hull of every paper & of the members (every other paper) with & without prefilter
+    bool checkHull(const std::string& name, const std::vector<glm::vec3>& positions)
+    {
+        bool passed {true};
+        std::vector<std::uint32_t> all(positions.size());
+        std::iota(all.begin(), all.end(), 0u);
+        std::vector<std::uint32_t> everyOther;
+        for (std::uint32_t i{0}; i < positions.size(); i += 2)
+        {
+            everyOther.push_back(i);
+        }
+        for (const std::vector<std::uint32_t>* members : {&all, &everyOther})
+        {
+            std::vector<glm::dvec3> filtered;
+            std::vector<glm::dvec3> unfiltered;
+            const int numCandidates {HullBuilder::build(positions, *members, true, filtered)};
+            const int numPoints {HullBuilder::build(positions, *members, false, unfiltered)};
+            const std::vector<glm::dvec3> filteredVertices {getHullVertices(filtered)};
+            const std::vector<glm::dvec3> unfilteredVertices {getHullVertices(unfiltered)};
+            const bool same {!unfilteredVertices.empty() && filteredVertices == unfilteredVertices};
+            std::cout << (same ? "ok   " : "FAIL ") << name << " (" << members->size() << " papers): " << numCandidates << "/" << numPoints
+                      << " candidates, " << filteredVertices.size() << " vs " << unfilteredVertices.size() << " hull vertices\n";
+            passed = passed && same;
+        }
+        return passed;
+    }
+
+    std::vector<glm::vec3> generate(const std::size_t numPoints, const std::function<glm::vec3(std::mt19937&)>& point)
+    {
+        std::mt19937 rng{1234};
+        std::vector<glm::vec3> positions(numPoints);
+        for (glm::vec3& position : positions)
+        {
+            position = point(rng);
+        }
+        return positions;
+    }
+}
+
+int main()
+{
+    std::uniform_real_distribution<float> uniform{-50.0f, 50.0f};
+    std::normal_distribution<float> normal{0.0f, 10.0f};
+    bool passed {true};
+    passed &= checkHull("uniform cube", generate(20000, [&](std::mt19937& rng) {
+        return glm::vec3{uniform(rng), uniform(rng), uniform(rng)};
+    }));
+    passed &= checkHull("gaussian blob", generate(50000, [&](std::mt19937& rng) {
+        return glm::vec3{normal(rng), normal(rng), normal(rng)} + glm::vec3{200.0f, -30.0f, 5.0f};
+    }));
+    passed &= checkHull("flat slab", generate(20000, [&](std::mt19937& rng) {
+        return glm::vec3{uniform(rng), uniform(rng) * 0.01f, uniform(rng) * 0.3f};
+    }));
+    // lots of papers near the surface, so most of them survive the prefilter
+    passed &= checkHull("sphere shell", generate(5000, [&](std::mt19937& rng) {
+        const glm::vec3 direction {normal(rng), normal(rng), normal(rng)};
+        return glm::normalize(direction) * (40.0f + uniform(rng) * 0.01f);
+    }));
+    // a few clumps, like clusters made of sub-clusters
+    passed &= checkHull("clumps", generate(30000, [&](std::mt19937& rng) {
+        const float clump {static_cast<float>(rng() % 5)};
+        return glm::vec3{normal(rng) * 0.2f + clump * 20.0f, normal(rng) * 0.2f - clump * clump, normal(rng) * 0.2f + std::sin(clump) * 30.0f};
+    }));
+    std::cout << (passed ? "All hulls match\n" : "Hulls differ\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+// Checks that the explored hulls (src/incremental_hull.h) match the convex hull of the papers they were grown to:
+// prefixes of point sets in awkward orders (sorted along an axis) & with lots of coplanar points (a grid) are
+// inserted in batches, every paper of the prefix has to be inside the hull & its volume has to match convhull_3d's.
+// usage: ./test_incremental_hull (returns non-zero if a hull differs)
+
+#include "../src/hull_builder.h"
+#include "../src/incremental_hull.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // relative to the size of the point set
+    constexpr double TOLERANCE {1e-6};
+
+    // volume enclosed by the faces (3 corners each, counter-clockwise seen from outside)
+    double getVolume(const std::vector<glm::dvec3>& corners)
+    {
+        double volume{0.0};
+        for (std::size_t c{0}; c + 2 < corners.size(); c += 3)
+        {
+            volume += glm::dot(corners[c], glm::cross(corners[c + 1], corners[c + 2])) / 6.0;
+        }
+        return volume;
+    }
+
+    // furthest any of the points is outside the faces, slivers (no wider than minWidth) don't have a reliable normal
+    double getMaxOutside(const std::vector<glm::dvec3>& corners, const std::vector<glm::vec3>& positions, const std::size_t numPoints,
+                         const double minWidth)
+    {
+        double outside{0.0};
+        for (std::size_t c{0}; c + 2 < corners.size(); c += 3)
+        {
+            const glm::dvec3 normal {glm::cross(corners[c + 1] - corners[c], corners[c + 2] - corners[c])};
+            const double length {glm::length(normal)};
+            const double longest {std::max({glm::length(corners[c + 1] - corners[c]), glm::length(corners[c + 2] - corners[c + 1]),
+                                            glm::length(corners[c] - corners[c + 2])})};
+            if (length <= minWidth * longest)
+            {
+                continue;
+            }
+            for (std::size_t i{0}; i < numPoints; ++i)
+            {
+                outside = std::max(outside, glm::dot(normal / length, glm::dvec3{positions[i]} - corners[c]));
+            }
+        }
+        return outside;
+    }
+
+    // hull of the first numPoints positions with convhull_3d, without duplicates (which it can't handle)
+    void buildExpected(const std::vector<glm::vec3>& positions, const std::size_t numPoints, std::vector<glm::dvec3>& corners)
+    {
+        std::vector<glm::vec3> unique {positions.begin(), positions.begin() + static_cast<std::ptrdiff_t>(numPoints)};
+        const auto less = [](const glm::vec3& a, const glm::vec3& b) {
+            return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+        };
+        std::sort(unique.begin(), unique.end(), less);
+        unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+        std::vector<std::uint32_t> members(unique.size());
+        std::iota(members.begin(), members.end(), 0u);
+        corners.clear();
+        HullBuilder::build(unique, members, false, corners);
+    }
+
+    // grows the hull one paper at a time, then in bigger & bigger batches, checking it after each step
+    bool checkHull(const std::string& name, const std::vector<glm::vec3>& positions)
+    {
+        std::vector<std::uint32_t> members(positions.size());
+        std::iota(members.begin(), members.end(), 0u);
+        glm::dvec3 min {positions[0]};
+        glm::dvec3 max {min};
+        for (const glm::vec3& position : positions)
+        {
+            min = glm::min(min, glm::dvec3{position});
+            max = glm::max(max, glm::dvec3{position});
+        }
+        const double size {glm::length(max - min)};
+
+        IncrementalHull hull;
+        hull.reset(positions, members);
+        bool passed {true};
+        std::vector<glm::dvec3> corners;
+        std::vector<glm::dvec3> expected;
+        for (std::size_t count{1}; count < positions.size(); count += std::max<std::size_t>(1, count / 2))
+        {
+            hull.insertUpTo(count);
+            if (!hull.hasVolume())
+            {
+                continue;
+            }
+            hull.getTriangles(corners);
+            buildExpected(positions, count, expected);
+            const double volume {getVolume(corners)};
+            const double expectedVolume {getVolume(expected)};
+            const double outside {getMaxOutside(corners, positions, count, TOLERANCE * size)};
+            if (std::abs(volume - expectedVolume) > TOLERANCE * expectedVolume || outside > TOLERANCE * size)
+            {
+                std::cout << "FAIL " << name << " (" << count << " papers): volume " << volume << " vs " << expectedVolume
+                          << ", papers up to " << outside << " outside\n";
+                passed = false;
+            }
+        }
+        hull.insertUpTo(positions.size());
+        hull.getTriangles(corners);
+        buildExpected(positions, positions.size(), expected);
+        std::cout << (passed ? "ok   " : "FAIL ") << name << " (" << positions.size() << " papers): " << corners.size() / 3
+                  << " faces, volume " << getVolume(corners) << " vs " << getVolume(expected) << "\n";
+        return passed;
+    }
+
+    std::vector<glm::vec3> generate(const std::size_t numPoints, const std::function<glm::vec3(std::mt19937&)>& point)
+    {
+        std::mt19937 rng{1234};
+        std::vector<glm::vec3> positions(numPoints);
+        for (glm::vec3& position : positions)
+        {
+            position = point(rng);
+        }
+        return positions;
+    }
+
+    // sorted by distance from origin, so every paper is a new hull vertex
+    std::vector<glm::vec3> sortedOutwards(std::vector<glm::vec3> positions)
+    {
+        std::ranges::sort(positions, {}, [](const glm::vec3& position) {return glm::length(position);});
+        return positions;
+    }
+}
+
+int main()
+{
+    std::uniform_real_distribution<float> uniform{-50.0f, 50.0f};
+    std::normal_distribution<float> normal{0.0f, 10.0f};
+    bool passed {true};
+    passed &= checkHull("gaussian blob", generate(20000, [&](std::mt19937& rng) {
+        return glm::vec3{normal(rng), normal(rng), normal(rng)} + glm::vec3{200.0f, -30.0f, 5.0f};
+    }));
+    passed &= checkHull("uniform cube sorted along x", [&] {
+        std::vector<glm::vec3> positions {generate(20000, [&](std::mt19937& rng) {
+            return glm::vec3{uniform(rng), uniform(rng), uniform(rng)};
+        })};
+        std::ranges::sort(positions, {}, [](const glm::vec3& position) {return position.x;});
+        return positions;
+    }());
+    passed &= checkHull("sphere shells outwards", sortedOutwards(generate(5000, [&](std::mt19937& rng) {
+        const glm::vec3 direction {normal(rng), normal(rng), normal(rng)};
+        return glm::normalize(direction) * (1.0f + static_cast<float>(rng() % 40));
+    })));
+    // whole numbers, so lots of papers are exactly on the same plane as others
+    passed &= checkHull("grid", generate(20000, [&](std::mt19937& rng) {
+        return glm::vec3{static_cast<float>(rng() % 8), static_cast<float>(rng() % 8), static_cast<float>(rng() % 8)};
+    }));
+    passed &= checkHull("grid sorted outwards", sortedOutwards(generate(20000, [&](std::mt19937& rng) {
+        return glm::vec3{static_cast<float>(rng() % 17) - 8.0f, static_cast<float>(rng() % 17) - 8.0f, static_cast<float>(rng() % 3)};
+    })));
+    // a tilted square with papers a little above & below it (floats can't be exactly on it), on top of a box
+    passed &= checkHull("noisy tilted square", [&] {
+        const glm::vec3 a {glm::normalize(glm::vec3{1.0f, 0.3f, 0.2f})};
+        const glm::vec3 b {glm::normalize(glm::cross(a, glm::vec3{0.1f, 1.0f, 0.4f}))};
+        const glm::vec3 n {glm::cross(a, b)};
+        std::uniform_real_distribution<float> side{-10.0f, 10.0f};
+        std::uniform_real_distribution<float> offset{-1e-6f, 1e-6f};
+        std::vector<glm::vec3> positions {generate(4, [&](std::mt19937& rng) {return -n * 30.0f + a * side(rng) + b * side(rng);})};
+        const std::vector<glm::vec3> square {generate(20000, [&](std::mt19937& rng) {return a * side(rng) + b * side(rng) + n * offset(rng);})};
+        positions.insert(positions.end(), square.begin(), square.end());
+        return positions;
+    }());
+    std::cout << (passed ? "All hulls match\n" : "Hulls differ\n");
+    return passed ? 0 : 1;
+}